@@ -0,0 +1,79 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+
+// Small request/response loops over a socketpair. With a pipeline depth
+// greater than 1, most reads find their data already buffered.
+
+enum { msgsize = 16 };
+int loops = 200000;
+int depth = 1;
+
+tamed void server(tamer::fd f) {
+    tvars { char buf[msgsize]; int r = 0; }
+    while (r == 0) {
+	twait { f.read(buf, msgsize, make_event(r)); }
+	if (r == 0)
+	    twait { f.write(buf, msgsize, make_event(r)); }
+    }
+}
+
+tamed void client(tamer::fd f, tamer::event<> done) {
+    tvars { char buf[msgsize]; int i, j, r = 0; }
+    memset(buf, 'x', msgsize);
+    for (i = 0; i < loops && r == 0; i += depth) {
+	for (j = 0; j < depth && r == 0; ++j)
+	    twait { f.write(buf, msgsize, make_event(r)); }
+	for (j = 0; j < depth && r == 0; ++j)
+	    twait { f.read(buf, msgsize, make_event(r)); }
+    }
+    f.close();
+    done.trigger();
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1)
+	depth = strtol(argv[1], 0, 0);
+    if (argc > 2)
+	loops = strtol(argv[2], 0, 0);
+    if (depth < 1)
+	depth = 1;
+
+    tamer::initialize();
+    int sv[2];
+    int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(x == 0);
+    tamer::fd::make_nonblocking(sv[0]);
+    tamer::fd::make_nonblocking(sv[1]);
+
+    tamer::set_now();
+    double start = tamer::dnow();
+    tamer::rendezvous<> r;
+    tamer::event<> e = make_event(r);
+    server(tamer::fd(sv[0]));
+    client(tamer::fd(sv[1]), e);
+    while (e)
+	tamer::once();
+    tamer::set_now();
+    double elapsed = tamer::dnow() - start;
+    printf("%d round trips (depth %d): %.3f s, %.0f/s\n",
+	   loops, depth, elapsed, loops / elapsed);
+    tamer::cleanup();
+}
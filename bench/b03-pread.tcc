@@ -0,0 +1,86 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+
+// Random block-sized preads against one file descriptor, with "depth"
+// readers in flight at once. Usage: b03-pread [DEPTH [COUNT [FILEMB]]].
+// Set TAMER_FILE_THREADS to change the number of worker threads.
+
+enum { blocksize = 4096 };
+int count = 100000;
+int depth = 1;
+long nblocks = 4096;
+int remaining;
+
+tamed void reader(tamer::fd f, tamer::event<> done) {
+    tvars { char buf[blocksize]; int r = 0; }
+    while (remaining > 0 && r == 0) {
+	--remaining;
+	twait {
+	    f.pread(buf, blocksize, (off_t) (random() % nblocks) * blocksize,
+		    make_event(r));
+	}
+    }
+    done.trigger();
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1)
+	depth = strtol(argv[1], 0, 0);
+    if (argc > 2)
+	count = strtol(argv[2], 0, 0);
+    if (argc > 3)
+	nblocks = strtol(argv[3], 0, 0) * (1048576 / blocksize);
+    if (depth < 1)
+	depth = 1;
+    if (nblocks < 1)
+	nblocks = 1;
+
+    char fn[100];
+    sprintf(fn, "/tmp/tamer-b03-%d", (int) getpid());
+    int wfd = ::open(fn, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    assert(wfd >= 0);
+    char block[blocksize];
+    memset(block, 'x', blocksize);
+    for (long i = 0; i < nblocks; ++i) {
+	ssize_t w = ::write(wfd, block, blocksize);
+	assert(w == blocksize);
+    }
+    ::close(wfd);
+
+    tamer::initialize();
+    tamer::fd f = tamer::fd::open(fn, O_RDONLY);
+    assert(f);
+    unlink(fn);
+
+    tamer::set_now();
+    double start = tamer::dnow();
+    remaining = count;
+    tamer::rendezvous<> r;
+    for (int i = 0; i < depth; ++i)
+	reader(f, make_event(r));
+    while (r.has_waiting())
+	tamer::once();
+    tamer::set_now();
+    double elapsed = tamer::dnow() - start;
+    printf("%d preads (depth %d): %.3f s, %.0f/s\n",
+	   count, depth, elapsed, count / elapsed);
+    tamer::cleanup();
+}
@@ -0,0 +1,130 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <algorithm>
+#include <vector>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+
+// Request/response round trips over loopback TCP under several socket
+// profiles. Each request is written as a header and a body, the pattern
+// that Nagle's algorithm and delayed acknowledgements combine to stall:
+// expect the default profile to be several orders of magnitude slower.
+// Usage: b04-sockprofile [COUNT [MSGSIZE]].
+
+enum { hdrsize = 8 };
+int count = 500;
+size_t msgsize = 64;
+
+tamed void server(tamer::fd l) {
+    tvars { tamer::fd f; std::vector<char> buf(msgsize); int r = 0; }
+    twait { l.accept(make_event(f)); }
+    while (f && r == 0) {
+	twait { f.read(&buf[0], msgsize, make_event(r)); }
+	if (r == 0)
+	    twait { f.write(&buf[0], msgsize, make_event(r)); }
+    }
+}
+
+tamed void client(tamer::fd f, std::vector<double> &rtt, tamer::event<> done) {
+    tvars { std::vector<char> buf(msgsize, 'x'); int i, r = 0; double t; }
+    for (i = 0; i < count && r == 0; ++i) {
+	tamer::set_now();
+	t = tamer::dnow();
+	twait { f.write(&buf[0], hdrsize, make_event(r)); }
+	twait { f.write(&buf[hdrsize], msgsize - hdrsize, make_event(r)); }
+	twait { f.read(&buf[0], msgsize, make_event(r)); }
+	tamer::set_now();
+	rtt.push_back(tamer::dnow() - t);
+    }
+    f.close();
+    done.trigger();
+}
+
+tamed void run(const char *name, tamer::socket_profile profile,
+	       tamer::event<> done) {
+    tvars {
+	tamer::fd l, f;
+	struct sockaddr_in sin;
+	socklen_t sinlen = sizeof(sin);
+	std::vector<double> rtt;
+	double sum = 0;
+	int ret;
+    }
+
+    l = tamer::tcp_listen(0);
+    assert(l);
+    ret = l.set_socket_profile(profile);
+    getsockname(l.value(), (struct sockaddr *) &sin, &sinlen);
+    server(l);
+    twait { tamer::tcp_connect(sin.sin_addr, ntohs(sin.sin_port),
+			       make_event(f)); }
+    assert(f);
+    if (ret >= 0)
+	ret = f.set_socket_profile(profile);
+    twait { client(f, rtt, make_event()); }
+    l.close();
+
+    std::sort(rtt.begin(), rtt.end());
+    for (size_t i = 0; i < rtt.size(); ++i)
+	sum += rtt[i];
+    printf("%-16s mean %8.1f us  p50 %8.1f us  p99 %8.1f us%s\n", name,
+	   sum * 1e6 / rtt.size(), rtt[rtt.size() / 2] * 1e6,
+	   rtt[rtt.size() * 99 / 100] * 1e6,
+	   ret < 0 ? "  (some options failed)" : "");
+    done.trigger();
+}
+
+tamed void run_all(tamer::event<> done) {
+    twait { run("default", tamer::socket_profile(), make_event()); }
+    twait { run("nodelay", tamer::socket_profile().nodelay(), make_event()); }
+    twait {
+	run("nodelay+quickack",
+	    tamer::socket_profile().nodelay().quickack(), make_event());
+    }
+    twait {
+	run("small-buffers",
+	    tamer::socket_profile().nodelay().notsent_lowat(16384)
+	    .send_buffer(65536).receive_buffer(65536), make_event());
+    }
+    twait {
+	run("busy-poll",
+	    tamer::socket_profile().nodelay().busy_poll(50), make_event());
+    }
+    done.trigger();
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1)
+	count = strtol(argv[1], 0, 0);
+    if (argc > 2)
+	msgsize = strtol(argv[2], 0, 0);
+    if (count < 1)
+	count = 1;
+    if (msgsize <= hdrsize)
+	msgsize = hdrsize + 1;
+
+    tamer::initialize();
+    tamer::rendezvous<> r;
+    run_all(make_event(r));
+    while (r.has_waiting())
+	tamer::once();
+    tamer::cleanup();
+}
@@ -0,0 +1,92 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <string>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+
+// Split a file into lines with buffer::take_until, for several line
+// lengths. Short lines measure per-call overhead; long lines measure the
+// delimiter scan. Usage: b05-takeline [MEGABYTES].
+
+long megabytes = 64;
+const size_t line_lengths[] = { 15, 79, 1023, 16383, 262143 };
+
+tamed void take_lines(const char *fn, size_t linelen, tamer::event<> done) {
+    tvars {
+	tamer::fd f;
+	tamer::buffer buf;
+	std::string line;
+	long nlines = 0;
+	double start;
+	int r = 0;
+    }
+
+    f = tamer::fd::open(fn, O_RDONLY);
+    assert(f);
+    tamer::set_now();
+    start = tamer::dnow();
+    while (r == 0) {
+	twait { buf.take_until(f, '\n', linelen + 1, line, make_event(r)); }
+	if (r == 0)
+	    ++nlines;
+    }
+    tamer::set_now();
+    double elapsed = tamer::dnow() - start;
+    printf("%7d-byte lines: %8ld lines, %.3f s, %7.1f MB/s\n",
+	   (int) linelen, nlines, elapsed,
+	   nlines * (linelen + 1) / elapsed / 1048576);
+    done.trigger();
+}
+
+tamed void run_all(const char *fn, tamer::event<> done) {
+    tvars { size_t i; }
+    for (i = 0; i < sizeof(line_lengths) / sizeof(line_lengths[0]); ++i) {
+	{
+	    int wfd = ::open(fn, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+	    assert(wfd >= 0);
+	    std::string line(line_lengths[i], 'x');
+	    line += '\n';
+	    for (long n = 0; n < megabytes * 1048576; n += line.length()) {
+		ssize_t w = ::write(wfd, line.data(), line.length());
+		assert(w == (ssize_t) line.length());
+	    }
+	    ::close(wfd);
+	}
+	twait { take_lines(fn, line_lengths[i], make_event()); }
+    }
+    unlink(fn);
+    done.trigger();
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1)
+	megabytes = strtol(argv[1], 0, 0);
+    if (megabytes < 1)
+	megabytes = 1;
+
+    char fn[100];
+    sprintf(fn, "/tmp/tamer-b05-%d", (int) getpid());
+    tamer::initialize();
+    tamer::rendezvous<> r;
+    run_all(fn, make_event(r));
+    while (r.has_waiting())
+	tamer::once();
+    tamer::cleanup();
+}
@@ -0,0 +1,181 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tamer/tamer.hh>
+#include <tamer/dns.hh>
+
+// Parse recorded DNS responses: with make_reply(), as the resolver does,
+// and by decompressing every name with a packet_reader. Also build
+// responses with a compressing packet_writer. Usage: b06-dnsparse [ROUNDS].
+
+long rounds = 1000000;
+
+// www.example.com: four A records, names compressed
+const uint8_t response1[] = {
+    0x00, 0x01, 0x81, 0x80, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x77, 0x77, 0x77, 0x07, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65,
+    0x03, 0x63, 0x6f, 0x6d, 0x00, 0x00, 0x01, 0x00, 0x01, 0xc0, 0x0c, 0x00,
+    0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2c, 0x00, 0x04, 0x5d, 0xb8, 0xd8,
+    0x22, 0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2d, 0x00,
+    0x04, 0x5d, 0xb8, 0xd8, 0x23, 0xc0, 0x0c, 0x00, 0x01, 0x00, 0x01, 0x00,
+    0x00, 0x01, 0x2e, 0x00, 0x04, 0x5d, 0xb8, 0xd8, 0x24, 0xc0, 0x0c, 0x00,
+    0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x2f, 0x00, 0x04, 0x5d, 0xb8, 0xd8,
+    0x25,
+};
+
+// api.service.internal.example.net: a CNAME and three A records
+const uint8_t response2[] = {
+    0x00, 0x02, 0x81, 0x80, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x61, 0x70, 0x69, 0x07, 0x73, 0x65, 0x72, 0x76, 0x69, 0x63, 0x65,
+    0x08, 0x69, 0x6e, 0x74, 0x65, 0x72, 0x6e, 0x61, 0x6c, 0x07, 0x65, 0x78,
+    0x61, 0x6d, 0x70, 0x6c, 0x65, 0x03, 0x6e, 0x65, 0x74, 0x00, 0x00, 0x01,
+    0x00, 0x01, 0xc0, 0x0c, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0x3c,
+    0x00, 0x10, 0x05, 0x6c, 0x62, 0x2d, 0x31, 0x37, 0x07, 0x75, 0x73, 0x2d,
+    0x65, 0x61, 0x73, 0x74, 0xc0, 0x21, 0xc0, 0x3e, 0x00, 0x01, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x1e, 0x00, 0x04, 0x0a, 0x01, 0x02, 0x03, 0xc0, 0x3e,
+    0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x04, 0x0a, 0x01,
+    0x02, 0x04, 0xc0, 0x3e, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1e,
+    0x00, 0x04, 0x0a, 0x01, 0x02, 0x05,
+};
+
+// 34.216.184.93.in-addr.arpa: one PTR record
+const uint8_t response3[] = {
+    0x00, 0x03, 0x81, 0x80, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x33, 0x34, 0x03, 0x32, 0x31, 0x36, 0x03, 0x31, 0x38, 0x34, 0x02,
+    0x39, 0x33, 0x07, 0x69, 0x6e, 0x2d, 0x61, 0x64, 0x64, 0x72, 0x04, 0x61,
+    0x72, 0x70, 0x61, 0x00, 0x00, 0x0c, 0x00, 0x01, 0xc0, 0x0c, 0x00, 0x0c,
+    0x00, 0x01, 0x00, 0x00, 0x0e, 0x10, 0x00, 0x1f, 0x0c, 0x65, 0x78, 0x61,
+    0x6d, 0x70, 0x6c, 0x65, 0x2d, 0x68, 0x6f, 0x73, 0x74, 0x04, 0x65, 0x64,
+    0x67, 0x65, 0x07, 0x65, 0x78, 0x61, 0x6d, 0x70, 0x6c, 0x65, 0x03, 0x63,
+    0x6f, 0x6d, 0x00,
+};
+
+// missing.example.com: NXDOMAIN
+const uint8_t response4[] = {
+    0x00, 0x04, 0x81, 0x83, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x07, 0x6d, 0x69, 0x73, 0x73, 0x69, 0x6e, 0x67, 0x07, 0x65, 0x78, 0x61,
+    0x6d, 0x70, 0x6c, 0x65, 0x03, 0x63, 0x6f, 0x6d, 0x00, 0x00, 0x01, 0x00,
+    0x01,
+};
+
+struct recorded {
+    const uint8_t *data;
+    size_t size;
+};
+const recorded responses[] = {
+    { response1, sizeof(response1) },
+    { response2, sizeof(response2) },
+    { response3, sizeof(response3) },
+    { response4, sizeof(response4) }
+};
+const int nresponses = sizeof(responses) / sizeof(responses[0]);
+
+void report(const char *what, long n, double start) {
+    tamer::set_now();
+    double elapsed = tamer::dnow() - start;
+    printf("%-12s %9ld packets, %.3f s, %6.1f ns/packet\n",
+           what, n, elapsed, elapsed * 1e9 / n);
+}
+
+void bench_reply() {
+    long naddrs = 0;
+    tamer::set_now();
+    double start = tamer::dnow();
+    for (long i = 0; i != rounds; ++i)
+        for (int j = 0; j != nresponses; ++j) {
+            tamer::dns::reply p = tamer::dns::make_reply(
+                tamer::dns::make_packet(const_cast<uint8_t *>(responses[j].data),
+                                        responses[j].size));
+            naddrs += p->addrs.size();
+        }
+    report("make_reply", rounds * nresponses, start);
+    assert(naddrs == rounds * 7);
+}
+
+// Decompress every name in a response, as a parser that keeps owner
+// names and CNAME targets would.
+size_t read_names(const uint8_t *data, size_t size, tamer::dns::arena &a) {
+    tamer::dns::packet_reader r(data, size, a);
+    uint16_t flags, qdcount, ancount, type, class_, rdlength;
+    uint32_t ttl;
+    const char *name;
+    size_t len, total = 0;
+    r.skip(2) >> flags >> qdcount >> ancount;
+    r.skip(4);
+    for (int i = 0; r && i != qdcount; ++i) {
+        r.read_name(name, len).skip(4);
+        total += len;
+    }
+    for (int i = 0; r && i != ancount; ++i) {
+        r.read_name(name, len) >> type >> class_ >> ttl >> rdlength;
+        total += len;
+        if (type == 5 || type == TYPE_PTR) {
+            r.read_name(name, len);
+            total += len;
+        } else
+            r.skip(rdlength);
+    }
+    assert(r);
+    return total;
+}
+
+void bench_reader() {
+    tamer::dns::arena a;
+    size_t total = 0;
+    tamer::set_now();
+    double start = tamer::dnow();
+    for (long i = 0; i != rounds; ++i)
+        for (int j = 0; j != nresponses; ++j) {
+            a.clear();
+            total += read_names(responses[j].data, responses[j].size, a);
+        }
+    report("reader names", rounds * nresponses, start);
+    assert(total > 0);
+}
+
+void bench_writer() {
+    uint8_t buf[512];
+    size_t total = 0;
+    uint32_t addr = htonl(0x5db8d822);
+    tamer::set_now();
+    double start = tamer::dnow();
+    for (long i = 0; i != rounds; ++i) {
+        tamer::dns::packet_writer w(buf, sizeof(buf));
+        w << (uint16_t) 1 << (uint16_t) 0x8180 << (uint16_t) 1
+          << (uint16_t) 4 << (uint16_t) 0 << (uint16_t) 0;
+        w.write_name("www.example.com", 15) << (uint16_t) 1 << (uint16_t) 1;
+        for (int j = 0; j != 4; ++j) {
+            w.write_name("www.example.com", 15) << (uint16_t) 1
+                << (uint16_t) 1 << (uint32_t) 300 << (uint16_t) 4;
+            w.write(&addr, 4);
+        }
+        total += w.size();
+    }
+    report("writer", rounds, start);
+    assert(total == rounds * sizeof(response1));
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1)
+        rounds = strtol(argv[1], 0, 0);
+    if (rounds < 1)
+        rounds = 1;
+    tamer::initialize();
+    bench_reply();
+    bench_reader();
+    bench_writer();
+    tamer::cleanup();
+}
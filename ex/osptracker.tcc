@@ -305,19 +305,9 @@ tamed void kill_connection(tamer::fd cfd, const std::string &s) {
 	cfd.close();
 }
 
-tamed void timeout_connection(tamer::fd cfd, int to, tamer::event<> *canceler) {
-	tvars { int ret; tamer::rendezvous<int> r; }
-	tamer::at_delay_sec(to, tamer::make_event(r, 0));
-	if (canceler)
-		*canceler = tamer::make_event(r, 1);
-	twait(r, ret);
-	if (ret == 0)
-		kill_connection(cfd, "500 Connection timed out: goodbye!\n");
-}
-
 tamed void notify(peer *pp, peer *cpeer)
 {
-	tvars { int ret; tamer::fd sock; struct sockaddr_in saddr; }
+	tvars { int ret; tamer::fd sock; }
 	pp->use();
 	cpeer->use();
 	twait {
@@ -329,6 +319,7 @@ tamed void notify(peer *pp, peer *cpeer)
 	twait {
 		sock.write("NOTIFY " + protect(cpeer->calias) + " " + std::string(inet_ntoa(cpeer->caddr)) + ":" + ntoa(cpeer->cport) + " OSP2P\n", make_event(ret));
 	}
+	// the protocol sends one NOTIFY per connection, ended by EOF
 	sock.close();
 	pp->unuse();
 	cpeer->unuse();
@@ -616,7 +607,6 @@ tamed void handle_connection(tamer::fd cfd) {
 		std::vector<std::string> words;
 		int n;
 		peer *cpeer = new peer(cfd), *pp;
-		tamer::event<> tocancel;
 		int timeout = SHORT_TIMEOUT;
 		std::vector<std::string> strs;
 	}
@@ -628,10 +618,11 @@ tamed void handle_connection(tamer::fd cfd) {
 200 Try 'HELP' to get a list of commands.\n", make_event(ret)); }
 
 	while (ret >= 0) {
-		timeout_connection(cfd, timeout, &tocancel);
+		cfd.set_read_deadline(tamer::dnow() + timeout);
 		twait { b.take_until(cfd, '\n', 4096, s, make_event(ret)); }
 		//fprintf(stderr, "%.*s\n", s.length(), s.data());
-		tocancel.trigger();
+		if (ret == tamer::outcome::timeout)
+			kill_connection(cfd, "500 Connection timed out: goodbye!\n");
 		timeout = LONG_TIMEOUT;
 		to_words(s, words);
 		if (!words.size() || ret < 0)
@@ -1,6 +1,7 @@
 #ifndef CACHE_HH
 #define CACHE_HH 1
 #include <tamer/tamer.hh>
+#include <tamer/mappedfile.hh>
 #include <assert.h>
 #include <stdlib.h>
 #include <string>
@@ -10,13 +11,13 @@ extern ssize_t g_cache_max;
 
 struct cache_entry {
 
-    cache_entry(const std::string &n, char *d, size_t len)
-	: _filename(n), _data(d), _len(len), _refcount(1), _next(0), _prev(0) {
+    cache_entry(const std::string &n, const std::string &hdr,
+		const tamer::mapped_file &f)
+	: _filename(n), _header(hdr), _file(f), _refcount(1), _next(0), _prev(0) {
     }
 
     ~cache_entry() {
 	assert(!_prev && !_next);
-	delete[] _data;
     }
 
     void use() {
@@ -28,19 +29,23 @@ struct cache_entry {
 	    delete this;
     }
 
-    char *data() const {
-	return _data;
+    const std::string &header() const {
+	return _header;
+    }
+
+    tamer::mapped_file file() const {
+	return _file;
     }
 
     size_t size() const {
-	return _len;
+	return _header.length() + _file.size();
     }
 
   private:
 
     std::string _filename;
-    char *_data;
-    size_t _len;
+    std::string _header;
+    tamer::mapped_file _file;
     unsigned _refcount;
     cache_entry *_next;
     cache_entry *_prev;
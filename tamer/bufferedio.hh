@@ -14,33 +14,192 @@
  * legally binding.
  */
 #include <string>
+#include <stdint.h>
 #include <tamer/tamer.hh>
 #include <tamer/fd.hh>
 namespace tamer {
 
 class buffer { public:
 
-    buffer(size_t initial_capacity = 1024);
+    /** @brief  A view of buffered data as one or two contiguous segments.
+     *
+     *  The second segment is nonempty only when the data wraps around the
+     *  end of the buffer's ring. A view is invalidated by the next
+     *  operation that reads into or consumes from the buffer. */
+    struct view {
+	const char *data[2];
+	size_t size[2];
+
+	inline size_t length() const;
+	inline bool contiguous() const;
+	inline char operator[](size_t i) const;
+	std::string str() const;
+    };
+
+    /** @brief  Length type for take_frame() naming a base-128 varint. */
+    struct varint {
+    };
+
+    buffer(size_t initial_capacity = 1024, bool mirrored = false);
     ~buffer();
 
+    inline size_t capacity() const;
+    inline size_t allocated() const;
+    inline bool mirrored() const;
+
     void fill_until(fd f, char c, size_t max_size, size_t &out_size, event<int> done);
     void take_until(fd f, char c, size_t max_size, std::string &str, event<int> done);
+    void fill_until(fd f, const std::string &delimiter, size_t max_size, size_t &out_size, event<int> done);
+    void take_until(fd f, const std::string &delimiter, size_t max_size, std::string &str, event<int> done);
+    void fill_until_any(fd f, const std::string &charset, size_t max_size, size_t &out_size, event<int> done);
+    void take_until_any(fd f, const std::string &charset, size_t max_size, std::string &str, event<int> done);
+
+    void peek_until(fd f, char c, size_t max_size, view &v, event<int> done);
+    void peek_until(fd f, const std::string &delimiter, size_t max_size, view &v, event<int> done);
+    void peek_until_any(fd f, const std::string &charset, size_t max_size, view &v, event<int> done);
+    view peek(size_t size) const;
+    inline view peek() const;
+    inline void consume(size_t size);
+
+    void take_exact(fd f, size_t size, view &v, event<int> done);
+    template <typename LengthT>
+    inline void take_frame(fd f, size_t max_size, view &v, event<int> done);
+
+    inline size_t buffered() const;
+    size_t take(void *buf, size_t size);
 
   private:
 
+    struct delimiter {
+	enum { d_char, d_string, d_set };
+	int type;
+	std::string str;
+	uint32_t set[8];
+
+	delimiter(char c);
+	delimiter(const std::string &s, bool any);
+	inline bool in_set(unsigned char c) const {
+	    return set[c >> 5] & (1U << (c & 31));
+	}
+    };
+
     char *_buf;
     size_t _size;
+    size_t _span;
     size_t _head;
     size_t _tail;
+    size_t _min_size;
+    size_t _peak;
+    unsigned _nfills;
+    bool _mirror;
+
+    enum { shrink_interval = 32 };
 
+    template <typename T> struct length_width {
+	enum { value = sizeof(T) };
+    };
+
+    char *allocate(size_t size, size_t &span) const;
+    bool resize(size_t size);
     ssize_t fill_more(fd f, const event<int> &done);
+    size_t find(size_t pos, size_t end, char c) const;
+    bool match(const delimiter &d, size_t &pos, size_t end) const;
+    void fill_match(fd f, delimiter d, size_t max_size, size_t &out_size, event<int> done);
+    void take_match(fd f, delimiter d, size_t max_size, std::string &str, event<int> done);
+    void peek_match(fd f, delimiter d, size_t max_size, view &v, event<int> done);
+    void fill_exact(fd f, size_t size, event<int> done);
+    void take_prefixed(fd f, int width, size_t max_size, view &v, event<int> done);
+
+    class closure__fill_match__2fd9delimiterkRkQi_;
+    void fill_match(closure__fill_match__2fd9delimiterkRkQi_ &);
+    class closure__take_match__2fd9delimiterkRSsQi_;
+    void take_match(closure__take_match__2fd9delimiterkRSsQi_ &);
+    class closure__peek_match__2fd9delimiterkR4viewQi_;
+    void peek_match(closure__peek_match__2fd9delimiterkR4viewQi_ &);
+    class closure__fill_exact__2fdkQi_;
+    void fill_exact(closure__fill_exact__2fdkQi_ &);
+    class closure__take_exact__2fdkR4viewQi_;
+    void take_exact(closure__take_exact__2fdkR4viewQi_ &);
+    class closure__take_prefixed__2fdikR4viewQi_;
+    void take_prefixed(closure__take_prefixed__2fdikR4viewQi_ &);
 
-    class closure__fill_until__2fdckRkQi_;
-    void fill_until(closure__fill_until__2fdckRkQi_ &);
-    class closure__take_until__2fdckRSsQi_;
-    void take_until(closure__take_until__2fdckRSsQi_ &);
+};
 
+template <> struct buffer::length_width<buffer::varint> {
+    enum { value = 0 };
 };
 
+/** @brief  Read a length-prefixed frame.
+ *  @tparam      LengthT   Length prefix type: an unsigned integer type,
+ *                         sent in network byte order, or buffer::varint.
+ *  @param       f         File descriptor.
+ *  @param       max_size  Maximum frame length, excluding the prefix.
+ *  @param[out]  v         Frame contents, excluding the prefix.
+ *  @param       done      Event triggered on completion.
+ *
+ *  Reads the prefix, then the frame it describes, and consumes both. @a v
+ *  points into the buffer and stays valid until the next read. @a done is
+ *  triggered with 0 on success, @c -E2BIG if the length exceeds @a
+ *  max_size (the prefix is left unconsumed), @c -EINVAL for a varint
+ *  longer than 10 bytes, tamer::outcome::closed on end-of-file, or another
+ *  negative error code.
+ */
+template <typename LengthT>
+inline void buffer::take_frame(fd f, size_t max_size, view &v, event<int> done) {
+    take_prefixed(f, length_width<LengthT>::value, max_size, v, done);
+}
+
+/** @brief  Return the total number of bytes in the view. */
+inline size_t buffer::view::length() const {
+    return size[0] + size[1];
+}
+
+/** @brief  Test if the view is a single segment. */
+inline bool buffer::view::contiguous() const {
+    return size[1] == 0;
+}
+
+/** @brief  Return the byte at offset @a i in the view. */
+inline char buffer::view::operator[](size_t i) const {
+    return i < size[0] ? data[0][i] : data[1][i - size[0]];
+}
+
+/** @brief  Return the buffer's current capacity in bytes. */
+inline size_t buffer::capacity() const {
+    return _size;
+}
+
+/** @brief  Return the number of bytes of storage the buffer holds.
+ *
+ *  This is 0 while the buffer is empty and waiting for input. */
+inline size_t buffer::allocated() const {
+    return _buf ? _size : 0;
+}
+
+/** @brief  Test if the buffer's storage is mapped twice in a row.
+ *
+ *  Data in a mirrored buffer never wraps, so every view is contiguous. */
+inline bool buffer::mirrored() const {
+    return _span != _size;
+}
+
+/** @brief  Return a view of all buffered data. */
+inline buffer::view buffer::peek() const {
+    return peek(_tail - _head);
+}
+
+/** @brief  Consume @a size bytes of buffered data.
+ *
+ *  @a size must not exceed buffered(). Invalidates views. */
+inline void buffer::consume(size_t size) {
+    assert(size <= _tail - _head);
+    _head += size;
+}
+
+/** @brief  Return the number of bytes read but not yet taken. */
+inline size_t buffer::buffered() const {
+    return _tail - _head;
+}
+
 }
 #endif /* TAMER_BUFFEREDIO_HH */
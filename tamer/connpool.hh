@@ -0,0 +1,59 @@
+#ifndef TAMER_CONNPOOL_HH
+#define TAMER_CONNPOOL_HH 1
+/* Copyright (c) 2007-2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <tamer/tamer.hh>
+#include <tamer/ref.hh>
+#include <tamer/fd.hh>
+#include <netinet/in.h>
+#include <stdint.h>
+namespace tamer {
+namespace tamerpriv { class connection_poolimp; }
+
+/** @file <tamer/connpool.hh>
+ *  @brief  A pool of reusable outbound TCP connections.
+ */
+
+class connection_pool {
+  public:
+    /** @brief  Counters maintained by a connection_pool. */
+    struct stats_type {
+        uint64_t connects;      ///< New connections attempted
+        uint64_t reuses;        ///< Checkouts satisfied by an idle connection
+        uint64_t stale;         ///< Idle connections found closed at checkout
+        uint64_t expired;       ///< Idle connections closed by idle expiry
+    };
+
+    explicit connection_pool(int max_per_host = 8, double idle_timeout = 60);
+    ~connection_pool();
+
+    void checkout(struct in_addr addr, int port, event<fd> result);
+    void checkin(struct in_addr addr, int port, fd f);
+    void clear();
+
+    int max_per_host() const;
+    double idle_timeout() const;
+    size_t idle_count() const;
+    const stats_type& stats() const;
+
+  private:
+    ref_ptr<tamerpriv::connection_poolimp> _p;
+
+    connection_pool(const connection_pool &);
+    connection_pool &operator=(const connection_pool &);
+
+    class closure__checkout__7in_addriQ2fd_; void checkout(closure__checkout__7in_addriQ2fd_&);
+};
+
+}
+#endif /* TAMER_CONNPOOL_HH */
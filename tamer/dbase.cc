@@ -81,6 +81,9 @@ void cleanup() {
     driver::main = 0;
 }
 
+void driver::watch_fd(int, int, bool) {
+}
+
 void driver::at_delay(double delay, event<> e)
 {
     if (delay <= 0)
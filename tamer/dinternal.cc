@@ -165,5 +165,33 @@ void driver_timerset::hard_cull(bool from_pop) const {
 	goto again;
 }
 
+
+chunk_pool::freelist chunk_pool::free_[chunk_pool::nclasses];
+
+/** Return a chunk of @a size bytes, which must satisfy pooled(). A free
+    chunk's first bytes point to the next free chunk of its class. */
+char *chunk_pool::allocate(size_t size) {
+    assert(pooled(size));
+    freelist &fl = free_[size_class(size)];
+    if (!fl.head)
+	return new char[size];
+    char *c = fl.head;
+    memcpy(&fl.head, c, sizeof(char *));
+    fl.nbytes -= size;
+    return c;
+}
+
+void chunk_pool::deallocate(char *c, size_t size) {
+    assert(pooled(size));
+    freelist &fl = free_[size_class(size)];
+    if (fl.nbytes + size > max_free_bytes)
+	delete[] c;
+    else {
+	memcpy(c, &fl.head, sizeof(char *));
+	fl.head = c;
+	fl.nbytes += size;
+    }
+}
+
 } // namespace tamerpriv
 } // namespace tamer
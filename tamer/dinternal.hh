@@ -11,9 +11,15 @@ template <typename T>
 struct driver_fd : public T {
     event<int> e[2];
     int next_changedfd1;
+    unsigned nwatch[2];
+    bool ready[2];
 
     template <typename O> inline driver_fd(O owner, int fd);
     inline bool empty() const;
+    inline bool wanted(int action) const;
+    inline bool take_ready(int action);
+    inline void trigger(int action);
+    inline void watch(int action, bool on);
 };
 
 template <typename T>
@@ -91,10 +97,45 @@ struct driver_timerset {
     void expand();
 };
 
+/* Free lists of power-of-two memory chunks shared by every buffer and
+   obuffer. Buffers borrow chunks only while they hold data, so idle
+   connections cost no buffer memory, and a burst of traffic is served from
+   memory recently released by other connections. */
+struct chunk_pool {
+    enum { min_chunk = 16, max_chunk = 65536, max_free_bytes = 1 << 20 };
+
+    static inline bool pooled(size_t size);
+    static char *allocate(size_t size);
+    static void deallocate(char *c, size_t size);
+
+  private:
+    enum { nclasses = 13 };     // min_chunk << (nclasses - 1) == max_chunk
+    struct freelist {
+	char *head;
+	size_t nbytes;
+    };
+    static freelist free_[nclasses];
+
+    static inline int size_class(size_t size);
+};
+
+
+inline bool chunk_pool::pooled(size_t size) {
+    return size >= min_chunk && size <= max_chunk && (size & (size - 1)) == 0;
+}
+
+inline int chunk_pool::size_class(size_t size) {
+    int c = 0;
+    for (size_t x = min_chunk; x != size; x *= 2)
+	++c;
+    return c;
+}
 
 template <typename T> template <typename O>
 inline driver_fd<T>::driver_fd(O owner, int fd)
     : T(owner, fd), next_changedfd1(0) {
+    nwatch[0] = nwatch[1] = 0;
+    ready[0] = ready[1] = false;
 }
 
 template <typename T>
@@ -102,6 +143,37 @@ inline bool driver_fd<T>::empty() const {
     return e[0].empty() && e[1].empty();
 }
 
+// A watched fd stays registered between waits. Registration is dropped only
+// when a notification arrives with nobody waiting; that readiness is then
+// remembered and delivered to the next waiter.
+template <typename T>
+inline bool driver_fd<T>::wanted(int action) const {
+    return e[action] || (nwatch[action] && !ready[action]);
+}
+
+template <typename T>
+inline bool driver_fd<T>::take_ready(int action) {
+    bool r = ready[action];
+    ready[action] = false;
+    return r;
+}
+
+template <typename T>
+inline void driver_fd<T>::trigger(int action) {
+    if (e[action])
+	e[action].trigger(0);
+    else if (nwatch[action])
+	ready[action] = true;
+}
+
+template <typename T>
+inline void driver_fd<T>::watch(int action, bool on) {
+    if (on)
+	++nwatch[action];
+    else if (nwatch[action] && --nwatch[action] == 0)
+	ready[action] = false;
+}
+
 template <typename T>
 inline driver_fd<T>& driver_fdset<T>::at(unsigned fd) {
     return fdblk_[fd / fdblksiz][fd % fdblksiz];
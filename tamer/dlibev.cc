@@ -42,6 +42,7 @@ public:
     virtual void at_time(const timeval &expiry, event<> e);
     virtual void at_asap(event<> e);
     virtual void kill_fd(int fd);
+    virtual void watch_fd(int fd, int action, bool on);
 
     virtual void loop(loop_flags flags);
     virtual void break_loop();
@@ -87,9 +88,9 @@ void libev_io_trigger(struct ev_loop *, ev_io *ev, int revents)
     driver_libev *d = static_cast<driver_libev *>(ev->data);
     tamerpriv::driver_fd<driver_libev::fdp> &x = d->fds_[ev->fd];
     if (revents & EV_READ)
-	x.e[0].trigger(0);
+	x.trigger(0);
     if (revents & EV_WRITE)
-	x.e[1].trigger(0);
+	x.trigger(1);
     d->fds_.push_change(ev->fd);
 }
 
@@ -131,6 +132,10 @@ void driver_libev::at_fd(int fd, int action, event<int> e) {
     if (e && (action == 0 || action == 1)) {
 	fds_.expand(this, fd);
 	tamerpriv::driver_fd<fdp>& x = fds_[fd];
+	if (x.take_ready(action)) {
+	    e.trigger(0);
+	    return;
+	}
 	if (x.e[action])
 	    e = tamer::distribute(TAMER_MOVE(x.e[action]), TAMER_MOVE(e));
 	x.e[action] = e;
@@ -143,8 +148,26 @@ void driver_libev::at_fd(int fd, int action, event<int> e) {
 void driver_libev::kill_fd(int fd) {
     if (fd >= 0 && fd < fds_.size()) {
 	tamerpriv::driver_fd<fdp> &x = fds_[fd];
-	for (int action = 0; action < 2; ++action)
+	for (int action = 0; action < 2; ++action) {
 	    x.e[action].trigger(-ECANCELED);
+	    x.nwatch[action] = 0;
+	    x.ready[action] = false;
+	}
+	// The descriptor is closed, and its number may be reused before
+	// update_fds() runs; drop its registration now.
+	if (ev_is_active(&x.base_.w)) {
+	    ev_io_stop(eloop_, &x.base_.io);
+	    --fdactive_;
+	}
+	fds_.push_change(fd);
+    }
+}
+
+void driver_libev::watch_fd(int fd, int action, bool on) {
+    assert(fd >= 0);
+    if (action == 0 || action == 1) {
+	fds_.expand(this, fd);
+	fds_[fd].watch(action, on);
 	fds_.push_change(fd);
     }
 }
@@ -153,7 +176,7 @@ void driver_libev::update_fds() {
     int fd;
     while ((fd = fds_.pop_change()) >= 0) {
 	tamerpriv::driver_fd<fdp> &x = fds_[fd];
-	unsigned want_what = (x.e[0] ? (int) EV_READ : 0) | (x.e[1] ? (int) EV_WRITE : 0);
+	unsigned want_what = (x.wanted(0) ? (int) EV_READ : 0) | (x.wanted(1) ? (int) EV_WRITE : 0);
 	unsigned have_what = (ev_is_active(&x.base_.w) ? x.base_.io.events : 0) & (EV_READ | EV_WRITE);
 	if (want_what != have_what) {
 	    fdactive_ += (want_what != 0) - (have_what != 0);
@@ -38,6 +38,7 @@ class driver_libevent : public driver {
     virtual void at_time(const timeval &expiry, event<> e);
     virtual void at_asap(event<> e);
     virtual void kill_fd(int fd);
+    virtual void watch_fd(int fd, int action, bool on);
 
     virtual void loop(loop_flags flags);
     virtual void break_loop();
@@ -72,9 +73,9 @@ void libevent_fdtrigger(int fd, short what, void *arg) {
     driver_libevent *d = static_cast<driver_libevent *>(arg);
     tamerpriv::driver_fd<driver_libevent::fdp> &x = d->fds_[fd];
     if (what & EV_READ)
-	x.e[0].trigger(0);
+	x.trigger(0);
     if (what & EV_WRITE)
-	x.e[1].trigger(0);
+	x.trigger(1);
     d->fds_.push_change(fd);
 }
 
@@ -117,6 +118,10 @@ void driver_libevent::at_fd(int fd, int action, event<int> e) {
     if (e && (action == 0 || action == 1)) {
 	fds_.expand(this, fd);
 	tamerpriv::driver_fd<fdp>& x = fds_[fd];
+	if (x.take_ready(action)) {
+	    e.trigger(0);
+	    return;
+	}
 	if (x.e[action])
 	    e = tamer::distribute(TAMER_MOVE(x.e[action]), TAMER_MOVE(e));
 	x.e[action] = e;
@@ -129,8 +134,26 @@ void driver_libevent::at_fd(int fd, int action, event<int> e) {
 void driver_libevent::kill_fd(int fd) {
     if (fd >= 0 && fd < fds_.size()) {
 	tamerpriv::driver_fd<fdp> &x = fds_[fd];
-	for (int action = 0; action < 2; ++action)
+	for (int action = 0; action < 2; ++action) {
 	    x.e[action].trigger(-ECANCELED);
+	    x.nwatch[action] = 0;
+	    x.ready[action] = false;
+	}
+	// The descriptor is closed, and its number may be reused before
+	// update_fds() runs; drop its registration now.
+	if (::event_pending(&x.base, EV_READ | EV_WRITE, 0) & (EV_READ | EV_WRITE)) {
+	    ::event_del(&x.base);
+	    --fdactive_;
+	}
+	fds_.push_change(fd);
+    }
+}
+
+void driver_libevent::watch_fd(int fd, int action, bool on) {
+    assert(fd >= 0);
+    if (action == 0 || action == 1) {
+	fds_.expand(this, fd);
+	fds_[fd].watch(action, on);
 	fds_.push_change(fd);
     }
 }
@@ -139,7 +162,7 @@ void driver_libevent::update_fds() {
     int fd;
     while ((fd = fds_.pop_change()) >= 0) {
 	tamerpriv::driver_fd<fdp> &x = fds_[fd];
-	int want_what = (x.e[0] ? EV_READ : 0) | (x.e[1] ? EV_WRITE : 0);
+	int want_what = (x.wanted(0) ? EV_READ : 0) | (x.wanted(1) ? EV_WRITE : 0);
 	int have_what = ::event_pending(&x.base, EV_READ | EV_WRITE, 0)
 	    & (EV_READ | EV_WRITE);
 	if (want_what != have_what) {
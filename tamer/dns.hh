@@ -40,6 +40,7 @@
 
 #define CLASS_INET     1
 #define TYPE_A         1
+#define TYPE_SOA       6
 #define TYPE_PTR       12
 
 namespace tamer {
@@ -254,6 +255,244 @@ inline packet_imp &packet_imp::operator<<(std::string val) {
   return *this;
 }
 
+/* Packets can also be read and written without allocating. A reader
+ * decompresses names straight into an arena that lives as long as the
+ * query; a writer compresses names against a small table of earlier
+ * names. Both check bounds once per field and fail stickily: after a bad
+ * read or a full buffer, the object converts to false and later calls do
+ * nothing.
+ */
+class arena {
+public:
+  enum { capacity = 4096 };
+
+  arena() : _used(0) {}
+
+  char *alloc(size_t size);
+  void clear();
+  size_t used() const;
+
+private:
+  char _buf[capacity];
+  size_t _used;
+
+  arena(const arena &);
+  arena &operator=(const arena &);
+};
+
+inline char *arena::alloc(size_t size) {
+  if (size > capacity - _used)
+    return 0;
+  _used += size;
+  return _buf + _used - size;
+}
+
+inline void arena::clear() {
+  _used = 0;
+}
+
+inline size_t arena::used() const {
+  return _used;
+}
+
+class packet_reader {
+  typedef void (packet_reader::*unspecified_bool_type)() const;
+  void unspecified_method() const {}
+
+  const uint8_t *_buf;
+  size_t _len;
+  size_t _off;
+  arena *_arena;
+  bool _ok;
+
+  bool check(size_t n);
+
+public:
+  packet_reader(const uint8_t *buf, size_t len, arena &a);
+
+  operator unspecified_bool_type() const;
+  size_t offset() const;
+
+  packet_reader &operator>>(uint8_t &val);
+  packet_reader &operator>>(uint16_t &val);
+  packet_reader &operator>>(uint32_t &val);
+  packet_reader &operator>>(struct in_addr &val);
+  packet_reader &skip(size_t n);
+  packet_reader &skip_name();
+  packet_reader &read_name(const char *&name, size_t &len);
+};
+
+inline packet_reader::packet_reader(const uint8_t *buf, size_t len, arena &a)
+  : _buf(buf), _len(len), _off(0), _arena(&a), _ok(true) {
+}
+
+inline packet_reader::operator unspecified_bool_type() const {
+  return _ok ? &packet_reader::unspecified_method : 0;
+}
+
+inline size_t packet_reader::offset() const {
+  return _off;
+}
+
+inline bool packet_reader::check(size_t n) {
+  if (_ok && n > _len - _off)
+    _ok = false;
+  return _ok;
+}
+
+inline packet_reader &packet_reader::operator>>(uint8_t &val) {
+  if (check(1))
+    val = _buf[_off++];
+  else
+    val = 0;
+  return *this;
+}
+
+inline packet_reader &packet_reader::operator>>(uint16_t &val) {
+  if (check(2)) {
+    val = (_buf[_off] << 8) | _buf[_off + 1];
+    _off += 2;
+  } else
+    val = 0;
+  return *this;
+}
+
+inline packet_reader &packet_reader::operator>>(uint32_t &val) {
+  if (check(4)) {
+    val = ((uint32_t) _buf[_off] << 24) | (_buf[_off + 1] << 16)
+      | (_buf[_off + 2] << 8) | _buf[_off + 3];
+    _off += 4;
+  } else
+    val = 0;
+  return *this;
+}
+
+inline packet_reader &packet_reader::operator>>(struct in_addr &val) {
+  if (check(4)) {
+    memcpy(&val.s_addr, _buf + _off, 4);
+    _off += 4;
+  } else
+    val.s_addr = 0;
+  return *this;
+}
+
+inline packet_reader &packet_reader::skip(size_t n) {
+  if (check(n))
+    _off += n;
+  return *this;
+}
+
+class packet_writer {
+  typedef void (packet_writer::*unspecified_bool_type)() const;
+  void unspecified_method() const {}
+
+  enum { max_names = 32 };
+
+  uint8_t *_buf;
+  size_t _cap;
+  size_t _off;
+  size_t _base;
+  bool _ok;
+  int _nnames;
+  uint16_t _names[max_names];
+
+  bool check(size_t n);
+  bool suffix_at(size_t pos, const char *s, size_t len) const;
+
+public:
+  packet_writer(uint8_t *buf, size_t cap);
+
+  operator unspecified_bool_type() const;
+  size_t size() const;
+  const uint8_t *data() const;
+
+  packet_writer &operator<<(uint8_t val);
+  packet_writer &operator<<(uint16_t val);
+  packet_writer &operator<<(uint32_t val);
+  packet_writer &operator<<(struct in_addr val);
+  packet_writer &write(const void *data, size_t n);
+  packet_writer &write_name(const char *name, size_t len, bool compress = true);
+  void begin_message();
+  void patch(size_t off, uint16_t val);
+};
+
+inline packet_writer::packet_writer(uint8_t *buf, size_t cap)
+  : _buf(buf), _cap(cap), _off(0), _base(0), _ok(true), _nnames(0) {
+}
+
+inline packet_writer::operator unspecified_bool_type() const {
+  return _ok ? &packet_writer::unspecified_method : 0;
+}
+
+inline size_t packet_writer::size() const {
+  return _off;
+}
+
+inline const uint8_t *packet_writer::data() const {
+  return _buf;
+}
+
+inline bool packet_writer::check(size_t n) {
+  if (_ok && n > _cap - _off)
+    _ok = false;
+  return _ok;
+}
+
+inline packet_writer &packet_writer::operator<<(uint8_t val) {
+  if (check(1))
+    _buf[_off++] = val;
+  return *this;
+}
+
+inline packet_writer &packet_writer::operator<<(uint16_t val) {
+  if (check(2)) {
+    _buf[_off] = val >> 8;
+    _buf[_off + 1] = val;
+    _off += 2;
+  }
+  return *this;
+}
+
+inline packet_writer &packet_writer::operator<<(uint32_t val) {
+  if (check(4)) {
+    _buf[_off] = val >> 24;
+    _buf[_off + 1] = val >> 16;
+    _buf[_off + 2] = val >> 8;
+    _buf[_off + 3] = val;
+    _off += 4;
+  }
+  return *this;
+}
+
+inline packet_writer &packet_writer::operator<<(struct in_addr val) {
+  return write(&val.s_addr, 4);
+}
+
+inline packet_writer &packet_writer::write(const void *data, size_t n) {
+  if (check(n)) {
+    memcpy(_buf + _off, data, n);
+    _off += n;
+  }
+  return *this;
+}
+
+// Start the DNS message at the current offset, after anything that is not
+// part of it, such as a TCP length prefix. Compression pointers are
+// offsets from the start of the message.
+inline void packet_writer::begin_message() {
+  _base = _off;
+  _nnames = 0;
+}
+
+// Overwrite a 16-bit field written earlier, such as a count or a TCP
+// length prefix. @a off is an offset into the buffer, not the message.
+inline void packet_writer::patch(size_t off, uint16_t val) {
+  if (_ok && off + 2 <= _off) {
+    _buf[off] = val >> 8;
+    _buf[off + 1] = val;
+  }
+}
+
 struct reply_imp : public enable_ref_ptr {
 private:
   typedef void (reply_imp::*unspecified_bool_type)() const;
@@ -267,10 +506,8 @@ public:
   std::string name;
 
   reply_imp(packet p);
+  reply_imp(const reply_imp &x, uint32_t ttl_);
   operator unspecified_bool_type() const;
-
-private:
-  static int skip_name(ref_ptr<packet_imp> &p);
 };
 
 inline reply make_reply(packet p) {
@@ -281,20 +518,6 @@ inline reply_imp::operator unspecified_bool_type() const {
   return (err) ? 0 : &reply_imp::unspecified_method;
 }
 
-inline int reply_imp::skip_name(ref_ptr<packet_imp> &p) {
-  uint8_t len;
-
-  while(*p) {
-    *p >> len;
-    if (!len) break; // done
-    if (len & 0xC0){ *p += 1; break; } // pointer
-    if (len > 63) return -1; // label too long
-    *p += len;
-  }
-
-  return *p ? 0 : -1; // read past the buffer?
-}
-
 struct search_list_imp : public enable_ref_ptr {
   int ndots;
   std::list<std::string> domains;
@@ -521,6 +744,81 @@ inline bool nameserver_imp::operator< (const nameserver_imp &n) const {
   return _addr < n._addr || (_addr == n._addr && _port < n._port);
 }
 
+/* Answers are cached by (name, type) until their TTL expires, with the
+ * TTL clamped to [min_ttl, max_ttl]. NXDOMAIN replies and replies without
+ * answers are cached too, for the SOA minimum in the authority section or
+ * negative_ttl if there is none. Answers the server sent with a TTL of 0,
+ * including truncated ones, are never cached. A hit returns the reply
+ * with its TTL lowered to the time the entry has left. Beyond capacity
+ * entries, the least recently used answer is evicted. Names compare
+ * case-insensitively.
+ */
+class answer_cache {
+public:
+  struct stats_type {
+    uint64_t hits;          ///< Lookups answered from the cache
+    uint64_t misses;        ///< Lookups that found no live entry
+    uint64_t negative_hits; ///< Hits on cached NXDOMAIN or empty answers
+    uint64_t evictions;     ///< Entries dropped to stay within capacity
+  };
+
+  answer_cache(size_t capacity = 1024, uint32_t min_ttl = 0,
+               uint32_t max_ttl = 86400, uint32_t negative_ttl = 60);
+
+  bool lookup(const std::string &name, uint16_t type, double now, reply &p);
+  void insert(const std::string &name, uint16_t type, reply p, double now);
+  void erase(const std::string &name, uint16_t type);
+  void flush();
+
+  inline size_t size() const;
+  inline size_t capacity() const;
+  void set_capacity(size_t capacity);
+  inline void set_ttl_limits(uint32_t min_ttl, uint32_t max_ttl);
+  inline void set_negative_ttl(uint32_t negative_ttl);
+  inline const stats_type &stats() const;
+
+private:
+  typedef std::pair<std::string, uint16_t> key_type;
+  struct entry {
+    key_type key;
+    reply p;
+    double expiry;
+  };
+  typedef std::list<entry> lru_type;
+
+  lru_type _lru;    // most recently used first
+  std::map<key_type, lru_type::iterator> _map;
+  size_t _capacity;
+  uint32_t _min_ttl;
+  uint32_t _max_ttl;
+  uint32_t _negative_ttl;
+  stats_type _stats;
+
+  static key_type make_key(const std::string &name, uint16_t type);
+  void remove(lru_type::iterator it);
+};
+
+inline size_t answer_cache::size() const {
+  return _map.size();
+}
+
+inline size_t answer_cache::capacity() const {
+  return _capacity;
+}
+
+inline void answer_cache::set_ttl_limits(uint32_t min_ttl, uint32_t max_ttl) {
+  _min_ttl = min_ttl;
+  _max_ttl = max_ttl < min_ttl ? min_ttl : max_ttl;
+}
+
+inline void answer_cache::set_negative_ttl(uint32_t negative_ttl) {
+  _negative_ttl = negative_ttl;
+}
+
+inline const answer_cache::stats_type &answer_cache::stats() const {
+  return _stats;
+}
+
 /////////////////////
 
 struct query {
@@ -559,9 +857,12 @@ class resolver : public enable_ref_ptr_with_full_release<resolver> {
 
   event<> _reparse;
 
+  answer_cache _cache;
+
   uint16_t get_trans_id();
 
   void resolve(request q, event<reply> e);
+  void resolve_cached(std::string key, uint16_t type, request q, event<reply> e);
 
   void add_nameservers(nameservers n, event<>);
   void handle_nameserver(nameserver n);
@@ -592,6 +893,9 @@ class resolver : public enable_ref_ptr_with_full_release<resolver> {
   class closure__resolve__7requestQ5reply_;
   void resolve(closure__resolve__7requestQ5reply_&);
 
+  class closure__resolve_cached__Ss8uint16_t7requestQ5reply_;
+  void resolve_cached(closure__resolve_cached__Ss8uint16_t7requestQ5reply_&);
+
   class closure__add_nameservers__11nameserversQ_;
   void add_nameservers(closure__add_nameservers__11nameserversQ_&);
 
@@ -619,6 +923,9 @@ class resolver : public enable_ref_ptr_with_full_release<resolver> {
     void resolve_a(std::string name, bool search, event<reply> e);
     void resolve_ptr(struct in_addr *in, event<reply> e);
 
+    answer_cache &cache();
+    const answer_cache &cache() const;
+
     void full_release();
 };
 
@@ -640,21 +947,47 @@ inline int resolver::error() const {
   return _err;
 }
 
+// Names resolved without the search list are cached in absolute form
+// ("www."), so they do not collide with searched lookups of the same text.
 inline void resolver::resolve_a(std::string name, bool search, event<reply> e) {
   request q;
+  reply p;
+  std::string key(name);
+
+  if (!search && (key.empty() || key[key.length() - 1] != '.'))
+    key += '.';
+  if (_cache.lookup(key, TYPE_A, dnow(), p)) {
+    e.trigger(p);
+    return;
+  }
 
   q = make_request_a(name, search, _search_list);
   if (!*q)
     e.trigger(reply());
   else
-    resolve(q, e);
+    resolve_cached(key, TYPE_A, q, e);
 }
 
 inline void resolver::resolve_ptr(struct in_addr *in, event<reply> e) {
   request q;
+  reply p;
+  std::string key(inet_ntoa(*in));
+
+  if (_cache.lookup(key, TYPE_PTR, dnow(), p)) {
+    e.trigger(p);
+    return;
+  }
 
   q = make_request_ptr(in);
-  resolve(q, e);
+  resolve_cached(key, TYPE_PTR, q, e);
+}
+
+inline answer_cache &resolver::cache() {
+  return _cache;
+}
+
+inline const answer_cache &resolver::cache() const {
+  return _cache;
 }
 
 inline void resolver::full_release() {
@@ -25,11 +25,46 @@
 #include <vector>
 #include <string>
 namespace tamer {
+class fd;
+namespace tamerpriv {
+class streamimp;
+class obufferimp;
+inline int fd_begin_job(const fd& f);
+inline void fd_end_job(const fd& f);
+}
 
 /** @file <tamer/fd.hh>
  *  @brief  Event-based file descriptor wrapper class.
  */
 
+class socket_profile {
+  public:
+    inline socket_profile();
+
+    inline socket_profile &nodelay(bool on = true);
+    inline socket_profile &receive_buffer(int size);
+    inline socket_profile &send_buffer(int size);
+    inline socket_profile &notsent_lowat(int size);
+    inline socket_profile &busy_poll(int usec);
+    inline socket_profile &quickack(bool on = true);
+    inline socket_profile &fastopen(int queue_length);
+
+    inline bool empty() const;
+    int apply(int f) const;
+    int apply_accepted(int f) const;
+
+  private:
+    enum {
+	o_nodelay, o_rcvbuf, o_sndbuf, o_notsent_lowat, o_busy_poll,
+	o_quickack, o_fastopen, nopt
+    };
+    int _set;
+    int _value[nopt];
+
+    inline socket_profile &set(int opt, int value);
+    int apply(int f, int mask) const;
+};
+
 class fd {
     struct fdimp;
 
@@ -66,6 +101,10 @@ class fd {
     inline void close(int errcode);
     inline void error_close(int errcode);
 
+    inline void set_read_deadline(double when);
+    inline void set_write_deadline(double when);
+    inline void set_deadline(double when);
+
     void read(void* buf, size_t size, size_t* nread_ptr, event<int> done);
     inline void read(void* buf, size_t size, size_t& nread, event<int> done);
     inline void read(void* buf, size_t size, size_t& nread, event<> done);
@@ -78,6 +117,7 @@ class fd {
     inline void read_once(void* buf, size_t size, size_t& nread, event<> done);
     void read_once(const struct iovec* iov, int iov_count, size_t& nread, event<int> done);
     inline void read_once(const struct iovec* iov, int iov_count, size_t& nread, event<> done);
+    ssize_t try_read(void* buf, size_t size);
 
     void write(const void* buf, size_t size, size_t* nwritten_ptr, event<int> done);
     inline void write(const void* buf, size_t size, size_t& nwritten, event<int> done);
@@ -96,9 +136,24 @@ class fd {
     inline void write_once(const void* buf, size_t size, size_t& nwritten, event<> done);
     void write_once(const struct iovec* iov, int iov_count, size_t& nwritten, event<int> done);
     inline void write_once(const struct iovec* iov, int iov_count, size_t& nwritten, event<> done);
-
-    void sendmsg(const void *buf, size_t size, int transfer_fd, event<int> done);
+    ssize_t try_write(const void* buf, size_t size);
+
+    void pread(void* buf, size_t size, off_t offset, size_t* nread_ptr, event<int> done);
+    inline void pread(void* buf, size_t size, off_t offset, size_t& nread, event<int> done);
+    inline void pread(void* buf, size_t size, off_t offset, event<int> done);
+    void pread(const struct iovec* iov, int iov_count, off_t offset, size_t* nread_ptr, event<int> done);
+    inline void pread(const struct iovec* iov, int iov_count, off_t offset, size_t& nread, event<int> done);
+    void pwrite(const void* buf, size_t size, off_t offset, size_t* nwritten_ptr, event<int> done);
+    inline void pwrite(const void* buf, size_t size, off_t offset, size_t& nwritten, event<int> done);
+    inline void pwrite(const void* buf, size_t size, off_t offset, event<int> done);
+    void pwrite(const struct iovec* iov, int iov_count, off_t offset, size_t* nwritten_ptr, event<int> done);
+    inline void pwrite(const struct iovec* iov, int iov_count, off_t offset, size_t& nwritten, event<int> done);
+
+    enum { max_transfer_fds = 253 };
+    void sendmsg(const void *buf, size_t size, const int *transfer_fds, int ntransfer, event<int> done);
+    inline void sendmsg(const void *buf, size_t size, int transfer_fd, event<int> done);
     inline void sendmsg(const void *buf, size_t size, event<int> done);
+    void recvmsg(void *buf, size_t size, size_t &nread, std::vector<fd> &received, event<int> done);
 
     void fstat(struct stat &stat, event<int> done);
 
@@ -109,6 +164,7 @@ class fd {
     void connect(const struct sockaddr *addr, socklen_t addrlen,
 		 event<int> done);
     inline int shutdown(int how);
+    int set_socket_profile(const socket_profile &profile);
 
     static int open_limit();
     static int open_limit(int n);
@@ -132,47 +188,114 @@ class fd {
 	passive_ref_ptr<fd::fdimp> _f;
     };
 
+    struct fddeadline {
+	fddeadline(fd::fdimp *f)
+	    : _f(f) {
+	}
+	void operator()(double when) {
+	    _f->deadline_timer(when);
+	}
+	passive_ref_ptr<fd::fdimp> _f;
+    };
+
     struct fdimp : public enable_ref_ptr_with_full_release<fdimp> {
 	int _fd;
 	mutex _rlock;
 	mutex _wlock;
 	event<> _at_close;
-#if HAVE_TAMER_FDHELPER
+	double _deadline[2];
+	double _deadline_at;
+	event<> _deadline_event;
+	event<> _waiter[2];
 	bool _is_file;
-#endif
+	socket_profile *_profile;
+	unsigned _njobs;
+	int _closing_fd;
 
 	fdimp(int fd)
-	    : _fd(fd)
-#if HAVE_TAMER_FDHELPER
-	    , _is_file(false)
-#endif
-	{
+	    : _fd(fd), _deadline_at(0), _is_file(false), _profile(0),
+	      _njobs(0), _closing_fd(-1) {
+	    _deadline[0] = _deadline[1] = 0;
+	}
+	~fdimp() {
+	    delete _profile;
 	}
 	void full_release() {
 	    if (_fd >= 0)
 		close();
 	}
 	int close(int leave_error = -EBADF);
+
+	// File I/O jobs run on worker threads. While any is in flight,
+	// close() leaves the descriptor open, so its number cannot be reused
+	// by an unrelated file under the job.
+	inline int begin_job();
+	void end_job();
+
+	inline bool expired(int action) const;
+	inline void wait(int action, event<> e);
+	void set_deadline(int action, double when);
+	void deadline_timer(double when);
     };
 
+    void read_slow(void* buf, size_t size, size_t pos, size_t* nread_ptr, event<int> done);
+    void read_once_slow(void* buf, size_t size, size_t& nread, event<int> done);
+    void write_slow(const void* buf, size_t size, size_t pos, size_t* nwritten_ptr, event<int> done);
+    void write_slow(std::string buf, size_t pos, size_t* nwritten_ptr, event<int> done);
+    void write_once_slow(const void* buf, size_t size, size_t& nwritten, event<int> done);
+
+    class closure__fstat__R4statQi_; void fstat(closure__fstat__R4statQi_&);
+    class closure__pread__Pvk5off_tPkQi_; void pread(closure__pread__Pvk5off_tPkQi_&);
+    class closure__pread__PK5ioveci5off_tPkQi_; void pread(closure__pread__PK5ioveci5off_tPkQi_&);
+    class closure__pwrite__PKvk5off_tPkQi_; void pwrite(closure__pwrite__PKvk5off_tPkQi_&);
+    class closure__pwrite__PK5ioveci5off_tPkQi_; void pwrite(closure__pwrite__PK5ioveci5off_tPkQi_&);
     class closure__accept__P8sockaddrP9socklen_tQ2fd_; void accept(closure__accept__P8sockaddrP9socklen_tQ2fd_&);
     class closure__connect__PK8sockaddr9socklen_tQi_; void connect(closure__connect__PK8sockaddr9socklen_tQi_&);
-    class closure__read__PvkPkQi_; void read(closure__read__PvkPkQi_&);
+    class closure__read_slow__PvkkPkQi_; void read_slow(closure__read_slow__PvkkPkQi_&);
     class closure__read__P5ioveciPkQi_; void read(closure__read__P5ioveciPkQi_&);
-    class closure__read_once__PvkRkQi_; void read_once(closure__read_once__PvkRkQi_ &);
+    class closure__read_once_slow__PvkRkQi_; void read_once_slow(closure__read_once_slow__PvkRkQi_&);
     class closure__read_once__PK5ioveciRkQi_; void read_once(closure__read_once__PK5ioveciRkQi_&);
-    class closure__write__PKvkPkQi_; void write(closure__write__PKvkPkQi_ &);
-    class closure__write__SsPkQi_; void write(closure__write__SsPkQi_ &);
+    class closure__write_slow__PKvkkPkQi_; void write_slow(closure__write_slow__PKvkkPkQi_&);
+    class closure__write_slow__SskPkQi_; void write_slow(closure__write_slow__SskPkQi_&);
     class closure__write__P5ioveciPkQi_; void write(closure__write__P5ioveciPkQi_&);
-    class closure__write_once__PKvkRkQi_; void write_once(closure__write_once__PKvkRkQi_ &);
+    class closure__write_once_slow__PKvkRkQi_; void write_once_slow(closure__write_once_slow__PKvkRkQi_&);
     class closure__write_once__PK5ioveciRkQi_; void write_once(closure__write_once__PK5ioveciRkQi_&);
-    class closure__sendmsg__PKvkiQi_; void sendmsg(closure__sendmsg__PKvkiQi_ &);
+    class closure__sendmsg__PKvkPKiiQi_; void sendmsg(closure__sendmsg__PKvkPKiiQi_ &);
+    class closure__recvmsg__PvkRkRNSt6vectorI2fdEEQi_; void recvmsg(closure__recvmsg__PvkRkRNSt6vectorI2fdEEQi_ &);
     class closure__open__PKci6mode_tQ2fd_; static void open(closure__open__PKci6mode_tQ2fd_ &);
 
     ref_ptr<fdimp> _p;
 
     friend bool operator==(const fd &a, const fd &b);
     friend bool operator!=(const fd &a, const fd &b);
+    friend class buffer;
+    friend class mapped_file;
+    friend class tamerpriv::streamimp;
+    friend class tamerpriv::obufferimp;
+    friend int tamerpriv::fd_begin_job(const fd& f);
+    friend void tamerpriv::fd_end_job(const fd& f);
+};
+
+class fd_watch {
+  public:
+    enum { read = driver::fdread, write = driver::fdwrite };
+
+    inline fd_watch();
+    fd_watch(const fd &f, int action);
+    inline ~fd_watch();
+
+    void watch(const fd &f, int action);
+    void wait(event<int> e);
+    inline void wait(event<> e);
+    void cancel();
+
+  private:
+    fd _f;
+    int _action;
+    event<int> _e;
+
+    fd_watch(const fd_watch &);
+    fd_watch &operator=(const fd_watch &);
 };
 
 void tcp_listen(int port, int backlog, event<fd> result);
@@ -180,8 +303,17 @@ inline void tcp_listen(int port, event<fd> result);
 fd tcp_listen(int port, int backlog);
 inline fd tcp_listen(int port);
 void tcp_connect(struct in_addr addr, int port, event<fd> result);
+void tcp_connect_send(struct in_addr addr, int port,
+		      const void *first_data, size_t first_len,
+		      event<fd> result);
+void tcp_connect_parallel(const std::vector<struct sockaddr_in> &addrs,
+			  size_t window, std::vector<fd> &results,
+			  event<> done);
 void udp_connect(struct in_addr addr, int port, event<fd> result);
 
+void send_fds(fd sock, const std::vector<fd> &fds, event<int> done);
+void receive_fds(fd sock, std::vector<fd> &fds, event<int> done);
+
 struct exec_fd {
     enum fdtype {
 	fdtype_newin, fdtype_newout, fdtype_share, fdtype_transfer
@@ -202,6 +334,82 @@ inline pid_t execvp(fd &in, fd &out, const char *program,
 		    const std::vector<const char *> &argv);
 inline pid_t execvp(fd &in, fd &out, fd &err, const char *program,
 		    const std::vector<const char *> &argv);
+void exec_wait(pid_t pid, event<int> status);
+
+
+/** @class socket_profile tamer/fd.hh <tamer/fd.hh>
+ *  @brief  A set of socket options applied together.
+ *
+ *  A socket_profile records the options a socket should have; options that
+ *  are never set are left at the system default. Attach a profile to a
+ *  listening socket with fd::set_socket_profile(), and accept() applies it
+ *  to each accepted connection. Options the system lacks are ignored.
+ */
+
+/** @brief  Construct an empty profile. */
+inline socket_profile::socket_profile()
+    : _set(0) {
+}
+
+inline socket_profile &socket_profile::set(int opt, int value) {
+    _set |= 1 << opt;
+    _value[opt] = value;
+    return *this;
+}
+
+/** @brief  Set @c TCP_NODELAY, which sends small writes without waiting to
+ *  coalesce them. */
+inline socket_profile &socket_profile::nodelay(bool on) {
+    return set(o_nodelay, on);
+}
+
+/** @brief  Set the kernel receive buffer size (@c SO_RCVBUF). */
+inline socket_profile &socket_profile::receive_buffer(int size) {
+    return set(o_rcvbuf, size);
+}
+
+/** @brief  Set the kernel send buffer size (@c SO_SNDBUF). */
+inline socket_profile &socket_profile::send_buffer(int size) {
+    return set(o_sndbuf, size);
+}
+
+/** @brief  Set @c TCP_NOTSENT_LOWAT, the amount of unsent data above which
+ *  the socket stops reporting writability.
+ *
+ *  A small value keeps queued data in user space, where it can still be
+ *  reordered or dropped, instead of in a large kernel send buffer. */
+inline socket_profile &socket_profile::notsent_lowat(int size) {
+    return set(o_notsent_lowat, size);
+}
+
+/** @brief  Set @c SO_BUSY_POLL, the number of microseconds a blocking
+ *  receive polls the device queue before sleeping.
+ *
+ *  Raising the value above the system default requires privileges. */
+inline socket_profile &socket_profile::busy_poll(int usec) {
+    return set(o_busy_poll, usec);
+}
+
+/** @brief  Set @c TCP_QUICKACK, which acknowledges data immediately
+ *  instead of delaying the acknowledgement. */
+inline socket_profile &socket_profile::quickack(bool on) {
+    return set(o_quickack, on);
+}
+
+/** @brief  Set @c TCP_FASTOPEN on a listening socket, allowing up to
+ *  @a queue_length pending connections whose SYNs carried data.
+ *
+ *  Clients such as tcp_connect_send() can then send their first request in
+ *  the SYN. Fast Open data may be replayed by the network, so enable it
+ *  only for servers whose first requests are safe to repeat. */
+inline socket_profile &socket_profile::fastopen(int queue_length) {
+    return set(o_fastopen, queue_length);
+}
+
+/** @brief  Test if the profile sets no options. */
+inline bool socket_profile::empty() const {
+    return !_set;
+}
 
 
 /** @brief  Construct an invalid file descriptor.
@@ -560,10 +768,85 @@ inline void fd::write_once(const struct iovec* iov, int iov_count, size_t& nwrit
     write_once(iov, iov_count, nwritten, unbind<int>(done));
 }
 
+/** @brief  Read from file descriptor at an offset.
+ *  @param[out]  buf     Buffer.
+ *  @param       size    Buffer size.
+ *  @param       offset  File offset.
+ *  @param[out]  nread   Number of characters read.
+ *  @param       done    Event triggered on completion.
+ *
+ *  Reads @a size bytes starting at @a offset, stopping early only at
+ *  end-of-file or an error condition. @a done is triggered with 0 on success
+ *  or end-of-file, or a negative error code; @a nread is set when @a done
+ *  triggers. The file position is not changed.
+ *
+ *  Unlike read(), positional reads and writes are not ordered with respect
+ *  to each other, so several may run at once on the same file descriptor.
+ *  They run on the file I/O worker threads.
+ */
+inline void fd::pread(void* buf, size_t size, off_t offset, size_t& nread, event<int> done) {
+    pread(buf, size, offset, &nread, done);
+}
+
+/** @overload */
+inline void fd::pread(void* buf, size_t size, off_t offset, event<int> done) {
+    pread(buf, size, offset, (size_t*) 0, done);
+}
+
+/** @brief  Read from file descriptor at an offset into an I/O vector.
+ *
+ *  Like pread(void*, size_t, off_t, size_t&, event<int>), but scatters the
+ *  data into @a iov. @a iov is never modified.
+ */
+inline void fd::pread(const struct iovec* iov, int iov_count, off_t offset, size_t& nread, event<int> done) {
+    pread(iov, iov_count, offset, &nread, done);
+}
+
+/** @brief  Write to file descriptor at an offset.
+ *  @param       buf       Buffer.
+ *  @param       size      Buffer size.
+ *  @param       offset    File offset.
+ *  @param[out]  nwritten  Number of characters written.
+ *  @param       done      Event triggered on completion.
+ *
+ *  Writes @a size bytes starting at @a offset. @a done is triggered with 0
+ *  on success, or a negative error code; @a nwritten is set when @a done
+ *  triggers. The file position is not changed.
+ *
+ *  @sa pread(void*, size_t, off_t, size_t&, event<int>)
+ */
+inline void fd::pwrite(const void* buf, size_t size, off_t offset, size_t& nwritten, event<int> done) {
+    pwrite(buf, size, offset, &nwritten, done);
+}
+
+/** @overload */
+inline void fd::pwrite(const void* buf, size_t size, off_t offset, event<int> done) {
+    pwrite(buf, size, offset, (size_t*) 0, done);
+}
+
+/** @brief  Write to file descriptor at an offset from an I/O vector.
+ *
+ *  Like pwrite(const void*, size_t, off_t, size_t&, event<int>), but gathers
+ *  the data from @a iov. @a iov is never modified.
+ */
+inline void fd::pwrite(const struct iovec* iov, int iov_count, off_t offset, size_t& nwritten, event<int> done) {
+    pwrite(iov, iov_count, offset, &nwritten, done);
+}
+
+
+/** @brief  Send a message on a file descriptor.
+ *  @param  buf          Buffer.
+ *  @param  size         Buffer size.
+ *  @param  transfer_fd  File descriptor to send with the message, or -1.
+ *  @param  done         Event triggered on completion.
+ */
+inline void fd::sendmsg(const void *buf, size_t size, int transfer_fd, event<int> done) {
+    sendmsg(buf, size, &transfer_fd, transfer_fd >= 0 ? 1 : 0, done);
+}
 
 /** @overload */
 inline void fd::sendmsg(const void *buf, size_t size, event<int> done) {
-    sendmsg(buf, size, -1, done);
+    sendmsg(buf, size, 0, 0, done);
 }
 
 /** @brief  Close file descriptor, marking it with an error.
@@ -585,6 +868,70 @@ inline void fd::error_close(int errcode) {
 }
 /** @endcond never */
 
+/** @brief  Set the read deadline.
+ *  @param  when  Absolute deadline, as returned by tamer::dnow(), or 0.
+ *
+ *  Once the deadline passes, any blocked read(), read_once(), or accept()
+ *  operation completes with tamer::outcome::timeout (@c -ETIMEDOUT), as do
+ *  any later read operations, until the deadline is reset. A @a when of 0
+ *  clears the deadline. The deadline is implemented with a single timer per
+ *  file descriptor, so it is cheap to push the deadline forward before every
+ *  operation.
+ */
+inline void fd::set_read_deadline(double when) {
+    if (_p)
+	_p->set_deadline(driver::fdread, when);
+}
+
+/** @brief  Set the write deadline.
+ *  @param  when  Absolute deadline, as returned by tamer::dnow(), or 0.
+ *
+ *  Like set_read_deadline(), but applies to write(), write_once(),
+ *  sendmsg(), and connect() operations.
+ */
+inline void fd::set_write_deadline(double when) {
+    if (_p)
+	_p->set_deadline(driver::fdwrite, when);
+}
+
+/** @brief  Set both the read and write deadlines.
+ *  @param  when  Absolute deadline, as returned by tamer::dnow(), or 0.
+ */
+inline void fd::set_deadline(double when) {
+    if (_p) {
+	_p->set_deadline(driver::fdread, when);
+	_p->set_deadline(driver::fdwrite, when);
+    }
+}
+
+inline bool fd::fdimp::expired(int action) const {
+    return _deadline[action] && _deadline[action] <= dnow();
+}
+
+inline void fd::fdimp::wait(int action, event<> e) {
+    _waiter[action] = e;
+    driver::main->at_fd(_fd, action, e);
+}
+
+inline int fd::fdimp::begin_job() {
+    ++_njobs;
+    return _fd;
+}
+
+namespace tamerpriv {
+// Return @a f's descriptor number for a file job, deferring any close() of
+// @a f until the matching fd_end_job(). The caller must keep @a f
+// referenced until then. Returns -EBADF if @a f is invalid.
+inline int fd_begin_job(const fd& f) {
+    return f._p ? f._p->begin_job() : -EBADF;
+}
+
+inline void fd_end_job(const fd& f) {
+    if (f._p)
+	f._p->end_job();
+}
+}
+
 /** @brief  Make this file descriptor use nonblocking I/O.
  */
 inline int fd::make_nonblocking() {
@@ -644,6 +991,23 @@ inline fd tcp_listen(int port) {
     return tcp_listen(port, fd::default_backlog);
 }
 
+/** @brief  Construct an inactive watcher. */
+inline fd_watch::fd_watch()
+    : _action(read) {
+}
+
+/** @brief  Destroy the watcher, canceling it. */
+inline fd_watch::~fd_watch() {
+    cancel();
+}
+
+/** @brief  Wait for the next readiness notification.
+ *  @param  e  Event triggered on readiness.
+ */
+inline void fd_watch::wait(event<> e) {
+    wait(event<int>(e, no_result()));
+}
+
 inline exec_fd::exec_fd(int child_fd, fdtype type, fd f)
     : child_fd(child_fd), type(type), f(f) {
 }
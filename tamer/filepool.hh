@@ -0,0 +1,104 @@
+#ifndef TAMER_FILEPOOL_HH
+#define TAMER_FILEPOOL_HH 1
+/* Copyright (c) 2007-2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <tamer/event.hh>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <string>
+#include <vector>
+namespace tamer {
+namespace tamerpriv {
+
+// A file_job is a blocking system call run by a worker thread. run() is
+// called on the worker; complete() is called on the main thread with run()'s
+// result, and by default triggers the job's event with it. A caller may
+// cancel the event, for instance with with_timeout(), and free its buffers
+// while the job still runs, so complete() copies results out only while
+// live() is true. A job may also have an owner event, usually the event of
+// the task that waits for it; results are then dropped once either event is
+// dead, and run() works only on memory the job owns.
+class file_job {
+  public:
+    inline file_job(const event<int>& done,
+                    const event<int>& owner = event<int>());
+    virtual ~file_job();
+
+    virtual int run() = 0;
+    virtual void complete(int result);
+
+  protected:
+    event<int> done_;
+
+    inline bool live() const;
+    inline bool owned() const;
+
+  private:
+    event<int> owner_;
+    bool owned_;
+    file_job* next_;
+    int result_;
+
+    friend class file_pool;
+};
+
+// Hand a job to the pool, which takes ownership. Without thread support, the
+// job runs immediately.
+void file_submit(file_job* job);
+
+enum {
+    file_once = 1       // read or write at most once
+};
+
+// The file descriptor passed to these functions must stay open until the
+// job completes; fd defers close() while it has jobs in flight. Without an
+// owner, the worker uses the caller's buffers directly, and they too must
+// outlive the job. With an owner, data to be written is copied at
+// submission, and read data is copied out on completion, subject to live().
+void file_open(const std::string& filename, int flags, mode_t mode,
+               bool* regular, event<int> done);
+void file_fstat(int fd, struct stat& stat_out, event<int> done,
+                event<int> owner = event<int>());
+void file_read(int fd, void* buf, size_t size, off_t offset, int flags,
+               size_t* nread, event<int> done,
+               event<int> owner = event<int>());
+void file_write(int fd, const void* buf, size_t size, off_t offset, int flags,
+                size_t* nwritten, event<int> done,
+                event<int> owner = event<int>());
+void file_readv(int fd, const struct iovec* iov, int iov_count, off_t offset,
+                int flags, size_t* nread, event<int> done,
+                event<int> owner = event<int>());
+void file_writev(int fd, const struct iovec* iov, int iov_count, off_t offset,
+                 int flags, size_t* nwritten, event<int> done,
+                 event<int> owner = event<int>());
+void file_fsync(int fd, bool datasync, event<int> done);
+
+inline file_job::file_job(const event<int>& done, const event<int>& owner)
+    : done_(done), owner_(owner), owned_(!owner.empty()), next_(0),
+      result_(0) {
+}
+
+// Test whether the job's results are still wanted.
+inline bool file_job::live() const {
+    return done_ && (!owned_ || owner_);
+}
+
+// Test whether the job has an owner event, and so may be cancelled.
+inline bool file_job::owned() const {
+    return owned_;
+}
+
+} // namespace tamerpriv
+} // namespace tamer
+#endif /* TAMER_FILEPOOL_HH */
@@ -0,0 +1,158 @@
+#ifndef TAMER_FS_HH
+#define TAMER_FS_HH 1
+/* Copyright (c) 2007-2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <tamer/tamer.hh>
+#include <tamer/ref.hh>
+#include <tamer/fd.hh>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+namespace tamer {
+
+/** @file <tamer/fs.hh>
+ *  @brief  Filesystem operations that run off the event loop.
+ */
+
+/** @namespace tamer::fs
+ *  @brief  Filesystem operations that run off the event loop.
+ *
+ *  Each function runs its system call on a file I/O worker thread, so a
+ *  slow disk stalls only the caller. Completion events are triggered with
+ *  0 on success or a negative error code. Arguments passed by reference
+ *  must remain valid until the completion event triggers.
+ */
+namespace fs {
+
+/** @brief  Operation types for which statistics are kept. */
+enum op_type {
+    op_stat, op_lstat, op_unlink, op_rename, op_mkdir, op_rmdir,
+    op_fsync, op_fdatasync, op_opendir, op_readdir,
+    nop_types
+};
+
+/** @brief  Counters for one operation type. */
+struct op_stats {
+    uint64_t count;             ///< Operations completed
+    uint64_t errors;            ///< Operations that returned an error
+    double latency_sum;         ///< Seconds from submission to completion,
+                                ///  summed over operations
+    double latency_max;         ///< Longest operation
+
+    inline op_stats();
+    inline double latency_mean() const;
+};
+
+const op_stats& stats(op_type op);
+const char* op_name(op_type op);
+void clear_stats();
+
+void stat(const std::string& path, struct stat& st, event<int> done);
+void lstat(const std::string& path, struct stat& st, event<int> done);
+void unlink(const std::string& path, event<int> done);
+void rename(const std::string& from, const std::string& to,
+            event<int> done);
+void mkdir(const std::string& path, mode_t mode, event<int> done);
+void rmdir(const std::string& path, event<int> done);
+void fsync(const fd& f, event<int> done);
+void fdatasync(const fd& f, event<int> done);
+
+class dir {
+    struct dirimp;
+
+  public:
+    typedef ref_ptr<dirimp> dir::*unspecified_bool_type;
+
+    inline dir();
+
+    static void open(const std::string& path, event<dir> result);
+
+    inline bool valid() const;
+    inline operator unspecified_bool_type() const;
+    inline bool operator!() const;
+    inline int error() const;
+
+    void read(std::vector<std::string>& names, size_t max, event<int> done);
+    void close();
+
+  private:
+    struct dirimp : public enable_ref_ptr {
+        DIR* _d;
+        int _error;
+        bool _reading;
+
+        dirimp()
+            : _d(0), _error(-EBADF), _reading(false) {
+        }
+        ~dirimp();
+    };
+
+    ref_ptr<dirimp> _p;
+
+    class closure__open__RKSsQ3dir_; static void open(closure__open__RKSsQ3dir_&);
+    class closure__read__RNSt6vectorISsEEkQi_; void read(closure__read__RNSt6vectorISsEEkQi_&);
+};
+
+inline void opendir(const std::string& path, event<dir> result);
+
+inline op_stats::op_stats()
+    : count(0), errors(0), latency_sum(0), latency_max(0) {
+}
+
+/** @brief  Return the mean operation latency in seconds. */
+inline double op_stats::latency_mean() const {
+    return count ? latency_sum / count : 0;
+}
+
+/** @brief  Construct an invalid directory handle. */
+inline dir::dir() {
+}
+
+/** @brief  Test if the directory handle is valid.
+ *  @return  True if the directory was opened and has not been closed. */
+inline bool dir::valid() const {
+    return _p && _p->_error >= 0;
+}
+
+/** @brief  Test if the directory handle is valid. */
+inline dir::operator unspecified_bool_type() const {
+    return valid() ? &dir::_p : 0;
+}
+
+/** @brief  Test if the directory handle is invalid. */
+inline bool dir::operator!() const {
+    return !valid();
+}
+
+/** @brief  Return error code.
+ *  @return  0 if the directory is open, otherwise a negative error code. */
+inline int dir::error() const {
+    return _p ? _p->_error : -EBADF;
+}
+
+/** @brief  Open a directory.
+ *  @param  path    Directory name.
+ *  @param  result  Event triggered on completion.
+ *
+ *  Equivalent to dir::open(@a path, @a result). */
+inline void opendir(const std::string& path, event<dir> result) {
+    dir::open(path, result);
+}
+
+} // namespace fs
+} // namespace tamer
+#endif /* TAMER_FS_HH */
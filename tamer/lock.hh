@@ -25,9 +25,11 @@ class mutex {
     inline mutex();
 
     inline void acquire(event<> done);
+    inline bool try_acquire();
     inline void release();
 
     inline void acquire_shared(event<> done);
+    inline bool try_acquire_shared();
     inline void release_shared();
 
   private:
@@ -68,6 +70,21 @@ inline void mutex::acquire(event<> done) {
     acquire(-1, done);
 }
 
+/** @brief  Acquire the mutex for exclusive access if it is available.
+ *  @return  True if the mutex was acquired.
+ *
+ *  Never blocks. Fails if the mutex is held or has waiters, so acquisition
+ *  order is preserved. On success, the mutex must later be released with
+ *  the release() method.
+ */
+inline bool mutex::try_acquire() {
+    if (!wait_ && locked_ == 0) {
+	locked_ = -1;
+	return true;
+    } else
+	return false;
+}
+
 /** @brief  Release a mutex acquired for exclusive access.
  *  @pre    The mutex must currently be acquired for exclusive access.
  *  @sa     acquire()
@@ -87,6 +104,20 @@ inline void mutex::acquire_shared(event<> done) {
     acquire(1, done);
 }
 
+/** @brief  Acquire the mutex for shared access if it is available.
+ *  @return  True if the mutex was acquired.
+ *
+ *  Never blocks. On success, the mutex must later be released with the
+ *  release_shared() method.
+ */
+inline bool mutex::try_acquire_shared() {
+    if (!wait_ && locked_ != -1) {
+	++locked_;
+	return true;
+    } else
+	return false;
+}
+
 /** @brief  Release a mutex acquired for shared access.
  *  @pre    The mutex must currently be acquired for shared access.
  *  @sa     acquire_shared()
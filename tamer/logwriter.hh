@@ -0,0 +1,77 @@
+#ifndef TAMER_LOGWRITER_HH
+#define TAMER_LOGWRITER_HH 1
+/* Copyright (c) 2007-2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <tamer/tamer.hh>
+#include <tamer/ref.hh>
+#include <tamer/fd.hh>
+#include <stdint.h>
+#include <string>
+namespace tamer {
+namespace tamerpriv { class log_writerimp; }
+
+/** @file <tamer/logwriter.hh>
+ *  @brief  Durable append-only logs with group commit.
+ */
+
+class log_writer {
+  public:
+    /** @brief  Counters maintained by a log_writer. */
+    struct stats_type {
+        uint64_t records;       ///< Records committed
+        uint64_t bytes;         ///< Bytes committed
+        uint64_t batches;       ///< Write-and-sync rounds
+        double latency_sum;     ///< Seconds from append to commit, summed
+                                ///  over records
+        double latency_max;     ///< Longest time from append to commit
+
+        inline double latency_mean() const;
+    };
+
+    explicit log_writer(const fd& f, double max_delay = 0,
+                        size_t max_batch = 1 << 20);
+    ~log_writer();
+
+    void append(const void* data, size_t size, event<int> done);
+    inline void append(const std::string& data, event<int> done);
+    void flush(event<int> done);
+
+    const fd& file() const;
+    double max_delay() const;
+    size_t max_batch() const;
+    size_t pending() const;
+    int error() const;
+    const stats_type& stats() const;
+
+  private:
+    ref_ptr<tamerpriv::log_writerimp> _p;
+
+    log_writer(const log_writer &);
+    log_writer &operator=(const log_writer &);
+};
+
+/** @brief  Append a record.
+ *  @param  data  Record contents.
+ *  @param  done  Event triggered once the record is on stable storage.
+ *  @sa append(const void*, size_t, event<int>) */
+inline void log_writer::append(const std::string& data, event<int> done) {
+    append(data.data(), data.length(), done);
+}
+
+/** @brief  Return the mean time from append to commit. */
+inline double log_writer::stats_type::latency_mean() const {
+    return records ? latency_sum / records : 0;
+}
+
+}
+#endif /* TAMER_LOGWRITER_HH */
@@ -0,0 +1,150 @@
+#ifndef TAMER_MAPPEDFILE_HH
+#define TAMER_MAPPEDFILE_HH 1
+/* Copyright (c) 2007-2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <tamer/tamer.hh>
+#include <tamer/ref.hh>
+#include <tamer/fd.hh>
+namespace tamer {
+
+/** @file <tamer/mappedfile.hh>
+ *  @brief  Read-only memory-mapped files.
+ */
+
+class mapped_file {
+    struct mapimp;
+
+  public:
+    typedef ref_ptr<mapimp> mapped_file::*unspecified_bool_type;
+
+    inline mapped_file();
+
+    static void open(const char* filename, event<mapped_file> result);
+
+    inline bool valid() const;
+    inline operator unspecified_bool_type() const;
+    inline bool operator!() const;
+    inline int error() const;
+
+    inline const char* data() const;
+    inline size_t size() const;
+    inline const fd& file() const;
+
+    void prefetch(size_t offset, size_t length, event<> done);
+    inline void prefetch(event<> done);
+
+    void write(fd out, size_t offset, size_t length, size_t* nwritten_ptr,
+               event<int> done);
+    inline void write(fd out, size_t offset, size_t length, size_t& nwritten,
+                      event<int> done);
+    inline void write(fd out, size_t& nwritten, event<int> done);
+
+  private:
+    struct mapimp : public enable_ref_ptr {
+        fd _f;
+        const char* _data;
+        size_t _size;
+        int _error;
+
+        mapimp()
+            : _data(0), _size(0), _error(-EBADF) {
+        }
+        ~mapimp();
+    };
+
+    ref_ptr<mapimp> _p;
+
+    class closure__open__PKcQ11mapped_file_; static void open(closure__open__PKcQ11mapped_file_&);
+    class closure__prefetch__kkQ_; void prefetch(closure__prefetch__kkQ_&);
+    class closure__write__2fdkkPkQi_; void write(closure__write__2fdkkPkQi_&);
+};
+
+/** @brief  Construct an invalid mapped file. */
+inline mapped_file::mapped_file() {
+}
+
+/** @brief  Test if mapped file is valid.
+ *  @return  True if the file was opened and mapped. */
+inline bool mapped_file::valid() const {
+    return _p && _p->_error >= 0;
+}
+
+/** @brief  Test if mapped file is valid.
+ *  @return  True if the file was opened and mapped. */
+inline mapped_file::operator unspecified_bool_type() const {
+    return valid() ? &mapped_file::_p : 0;
+}
+
+/** @brief  Test if mapped file is invalid.
+ *  @return  True if the file was not opened and mapped. */
+inline bool mapped_file::operator!() const {
+    return !valid();
+}
+
+/** @brief  Return error code.
+ *  @return  0 if the file is valid, otherwise a negative error code. */
+inline int mapped_file::error() const {
+    return _p ? _p->_error : -EBADF;
+}
+
+/** @brief  Return the mapped file data.
+ *
+ *  Touching pages that are not yet in memory blocks the calling thread; use
+ *  prefetch() first to bring them in off the event loop. */
+inline const char* mapped_file::data() const {
+    return _p ? _p->_data : 0;
+}
+
+/** @brief  Return the mapped file's size. */
+inline size_t mapped_file::size() const {
+    return _p ? _p->_size : 0;
+}
+
+/** @brief  Return the underlying file descriptor. */
+inline const fd& mapped_file::file() const {
+    static const fd invalid;
+    return _p ? _p->_f : invalid;
+}
+
+/** @brief  Prefetch the whole file.
+ *  @param  done  Event triggered once the file is in memory.
+ *  @sa prefetch(size_t, size_t, event<>) */
+inline void mapped_file::prefetch(event<> done) {
+    prefetch(0, size(), done);
+}
+
+/** @brief  Write part of the file to a file descriptor.
+ *  @param       out       Output file descriptor.
+ *  @param       offset    Offset of the first byte to write.
+ *  @param       length    Number of bytes to write.
+ *  @param[out]  nwritten  Number of bytes written.
+ *  @param       done      Event triggered on completion.
+ *
+ *  Copies data to @a out without passing it through a user buffer, using
+ *  sendfile() where the system supports it. Writes are ordered with
+ *  respect to other writes on @a out. The range is clipped to the file's
+ *  size. @a done is triggered with 0 on success, or a negative error code.
+ */
+inline void mapped_file::write(fd out, size_t offset, size_t length,
+                               size_t& nwritten, event<int> done) {
+    write(out, offset, length, &nwritten, done);
+}
+
+/** @brief  Write the whole file to a file descriptor.
+ *  @sa write(fd, size_t, size_t, size_t&, event<int>) */
+inline void mapped_file::write(fd out, size_t& nwritten, event<int> done) {
+    write(out, 0, size(), &nwritten, done);
+}
+
+}
+#endif /* TAMER_MAPPEDFILE_HH */
@@ -0,0 +1,78 @@
+#ifndef TAMER_OBUFFER_HH
+#define TAMER_OBUFFER_HH 1
+/* Copyright (c) 2007-2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <tamer/tamer.hh>
+#include <tamer/ref.hh>
+#include <tamer/fd.hh>
+#include <stdarg.h>
+#include <string.h>
+#include <string>
+namespace tamer {
+namespace tamerpriv { class obufferimp; }
+
+/** @file <tamer/obuffer.hh>
+ *  @brief  Buffered output with automatic flushing.
+ */
+
+class obuffer {
+  public:
+    explicit obuffer(const fd& f, size_t flush_threshold = 65536,
+                     bool autoflush = true);
+    ~obuffer();
+
+    const fd& file() const;
+
+    void append(const void* data, size_t size);
+    inline void append(const std::string& str);
+    inline void append(const char* str);
+    void printf(const char* format, ...)
+        __attribute__((format(printf, 2, 3)));
+    void vprintf(const char* format, va_list val);
+
+    void flush(event<int> done);
+    inline void flush();
+
+    size_t pending() const;
+    size_t flush_threshold() const;
+    bool autoflush() const;
+    int error() const;
+
+  private:
+    ref_ptr<tamerpriv::obufferimp> _p;
+
+    obuffer(const obuffer &);
+    obuffer &operator=(const obuffer &);
+};
+
+/** @brief  Append @a str.
+ *  @sa append(const void*, size_t) */
+inline void obuffer::append(const std::string& str) {
+    append(str.data(), str.length());
+}
+
+/** @brief  Append the null-terminated string @a str.
+ *  @sa append(const void*, size_t) */
+inline void obuffer::append(const char* str) {
+    append(str, strlen(str));
+}
+
+/** @brief  Start writing buffered data.
+ *
+ *  Equivalent to flush(event<int>()). */
+inline void obuffer::flush() {
+    flush(event<int>());
+}
+
+}
+#endif /* TAMER_OBUFFER_HH */
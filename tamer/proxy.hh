@@ -0,0 +1,54 @@
+#ifndef TAMER_PROXY_HH
+#define TAMER_PROXY_HH 1
+/* Copyright (c) 2007-2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <stdint.h>
+namespace tamer {
+
+/** @file <tamer/proxy.hh>
+ *  @brief  Forward bytes between two file descriptors.
+ */
+
+/** @brief  Counters maintained by proxy(). */
+struct proxy_stats {
+    /** @brief  Counters for one direction. */
+    struct direction {
+        uint64_t bytes;         ///< Bytes forwarded
+        uint64_t bursts;        ///< Times buffered data was fully flushed
+        double latency_sum;     ///< Seconds data spent buffered, summed
+                                ///  over bursts
+        double latency_max;     ///< Longest time data spent buffered
+
+        inline direction();
+        inline double latency_mean() const;
+    };
+
+    direction a_to_b;           ///< Data read from @a a and written to @a b
+    direction b_to_a;           ///< Data read from @a b and written to @a a
+};
+
+void proxy(fd a, fd b, proxy_stats& stats, event<int> done);
+
+inline proxy_stats::direction::direction()
+    : bytes(0), bursts(0), latency_sum(0), latency_max(0) {
+}
+
+/** @brief  Return the mean time data spent buffered per burst. */
+inline double proxy_stats::direction::latency_mean() const {
+    return bursts ? latency_sum / bursts : 0;
+}
+
+}
+#endif /* TAMER_PROXY_HH */
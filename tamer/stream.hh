@@ -0,0 +1,112 @@
+#ifndef TAMER_STREAM_HH
+#define TAMER_STREAM_HH 1
+/* Copyright (c) 2007-2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <tamer/tamer.hh>
+#include <tamer/ref.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+#include <string>
+namespace tamer {
+namespace tamerpriv { class streamimp; }
+
+/** @file <tamer/stream.hh>
+ *  @brief  Buffered full-duplex streams with output flow control.
+ */
+
+class stream {
+  public:
+    class chunk : public enable_ref_ptr {
+      public:
+        inline chunk(const void* data, size_t size);
+        inline explicit chunk(const std::string& str);
+
+        inline const char* data() const;
+        inline size_t size() const;
+
+      private:
+        std::string _s;
+    };
+
+    explicit stream(const fd& f, size_t high_watermark = 65536,
+                    size_t low_watermark = 16384);
+    ~stream();
+
+    const fd& file() const;
+
+    bool write(const void* data, size_t size);
+    inline bool write(const std::string& str);
+    bool write(const ref_ptr<chunk>& c);
+    void wait_writable(event<> e);
+    void flush(event<int> done);
+    void shutdown_write(event<int> done);
+    inline void shutdown_write();
+
+    size_t queued() const;
+    bool writable() const;
+    size_t high_watermark() const;
+    size_t low_watermark() const;
+    int write_error() const;
+
+    void read_once(void* buf, size_t size, size_t& nread, event<int> done);
+    void take_until(char c, size_t max_size, std::string& str,
+                    event<int> done);
+    bool read_closed() const;
+
+    void close();
+
+  private:
+    ref_ptr<tamerpriv::streamimp> _p;
+
+    stream(const stream &);
+    stream &operator=(const stream &);
+
+    class closure__read_once__PvkRkQi_; void read_once(closure__read_once__PvkRkQi_&);
+    class closure__take_until__ckRSsQi_; void take_until(closure__take_until__ckRSsQi_&);
+};
+
+/** @brief  Construct a chunk holding a copy of @a data. */
+inline stream::chunk::chunk(const void* data, size_t size)
+    : _s(static_cast<const char*>(data), size) {
+}
+
+/** @brief  Construct a chunk holding a copy of @a str. */
+inline stream::chunk::chunk(const std::string& str)
+    : _s(str) {
+}
+
+/** @brief  Return the chunk's data. */
+inline const char* stream::chunk::data() const {
+    return _s.data();
+}
+
+/** @brief  Return the chunk's size. */
+inline size_t stream::chunk::size() const {
+    return _s.length();
+}
+
+/** @brief  Queue @a str for writing.
+ *  @sa write(const void*, size_t) */
+inline bool stream::write(const std::string& str) {
+    return write(str.data(), str.length());
+}
+
+/** @brief  Shut down the write half once queued data is written.
+ *
+ *  Equivalent to shutdown_write(event<int>()). */
+inline void stream::shutdown_write() {
+    shutdown_write(event<int>());
+}
+
+}
+#endif /* TAMER_STREAM_HH */
@@ -48,6 +48,7 @@ class driver : public tamerpriv::simple_driver {
     virtual void at_time(const timeval &expiry, event<> e) = 0;
     virtual void at_asap(event<> e) = 0;
     virtual void kill_fd(int fd) = 0;
+    virtual void watch_fd(int fd, int action, bool on);
 
     inline void at_fd(int fd, int action, event<> e);
     inline void at_fd_read(int fd, event<int> e);
@@ -0,0 +1,70 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+using namespace tamer;
+
+tamed void test_read(tamer::fd rfd, tamer::fd wfd) {
+    tvars { char buf[10]; size_t nread; int ret; double start;
+        tamer::buffer b; std::string str; }
+
+    // read times out
+    start = tamer::dnow();
+    rfd.set_read_deadline(start + 0.05);
+    twait { rfd.read(buf, 4, nread, make_event(ret)); }
+    printf("read %d %s %d\n", (int) nread, strerror(-ret),
+           tamer::dnow() - start >= 0.04);
+
+    // later reads time out immediately
+    twait { rfd.read_once(buf, 4, nread, make_event(ret)); }
+    printf("read_once %d %s\n", (int) nread, strerror(-ret));
+
+    // moving the deadline forward reenables reads
+    rfd.set_read_deadline(tamer::dnow() + 0.2);
+    twait {
+        rfd.read(buf, 4, nread, make_event(ret));
+        tamer::at_delay_msec(20, make_event());
+        wfd.write("Hey!", 4, make_event());
+    }
+    printf("read %d %d %.4s\n", (int) nread, ret, buf);
+
+    // the deadline also applies to buffered reads
+    twait { tamer::at_delay_msec(200, make_event()); }
+    rfd.set_read_deadline(tamer::dnow() + 0.05);
+    twait { wfd.write("part", 4, make_event()); }
+    twait { b.take_until(rfd, '\n', 1024, str, make_event(ret)); }
+    printf("take_until %s\n", strerror(-ret));
+
+    // clearing the deadline
+    rfd.set_read_deadline(0);
+    twait {
+        rfd.read(buf, 4, nread, make_event(ret));
+        tamer::at_delay_msec(100, make_event());
+        wfd.write("Bye!", 4, make_event());
+    }
+    printf("read %d %d %.4s\n", (int) nread, ret, buf);
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    tamer::fd pfd[2];
+    int r = tamer::fd::pipe(pfd);
+    assert(r == 0);
+    test_read(pfd[0], pfd[1]);
+    tamer::loop();
+    tamer::cleanup();
+}
@@ -0,0 +1,74 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+using namespace tamer;
+
+tamed void writer(tamer::fd wfd) {
+    tvars { int i; }
+    for (i = 0; i != 3; ++i) {
+        twait { tamer::at_delay_msec(10, make_event()); }
+        twait { wfd.write("xy", 2, make_event()); }
+    }
+    twait { tamer::at_delay_msec(10, make_event()); }
+    wfd.close();
+}
+
+tamed void reader(tamer::fd rfd) {
+    tvars { tamer::fd_watch w(rfd, tamer::fd_watch::read); int ret; char buf[10];
+        ssize_t amt; int nwake = 0; }
+    while (1) {
+        amt = ::read(rfd.value(), buf, 1);
+        if (amt > 0)
+            printf("read %c\n", buf[0]);
+        else if (amt == 0) {
+            printf("eof\n");
+            break;
+        } else {
+            twait { w.wait(make_event(ret)); }
+            ++nwake;
+            if (ret < 0) {
+                printf("wait %s\n", strerror(-ret));
+                break;
+            }
+        }
+    }
+    printf("woke %d\n", nwake >= 3 && nwake <= 6);
+
+    // a pending wait is canceled along with the watch
+    twait {
+        w.wait(make_event(ret));
+        w.cancel();
+    }
+    printf("wait %s\n", strerror(-ret));
+
+    // closing the fd cancels the watch
+    w.watch(rfd, tamer::fd_watch::read);
+    rfd.close();
+    twait { w.wait(make_event(ret)); }
+    printf("wait %s\n", strerror(-ret));
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    tamer::fd pfd[2];
+    int r = tamer::fd::pipe(pfd);
+    assert(r == 0);
+    reader(pfd[0]);
+    writer(pfd[1]);
+    tamer::loop();
+    tamer::cleanup();
+}
@@ -0,0 +1,130 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+using namespace tamer;
+
+tamed void test_file(std::string fn) {
+    tvars { tamer::fd f, g; int ret, ret2; size_t n, n2; struct stat st;
+        char buf[40], buf2[40]; struct iovec iov[2]; event<int> e;
+        rendezvous<> rv; }
+
+    // missing files report errors
+    twait { tamer::fd::open("/nonexistent/t17", O_RDONLY, make_event(f)); }
+    printf("open %s\n", strerror(-f.error()));
+
+    // write through the file pool
+    twait { tamer::fd::open(fn.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600,
+                            make_event(f)); }
+    printf("open %d\n", f.valid());
+    twait {
+        f.write("Hello, ", 7, make_event(ret));
+        f.write(std::string("world!\n"), make_event(ret2));
+    }
+    printf("write %d %d\n", ret, ret2);
+    iov[0].iov_base = (void*) "abc";
+    iov[0].iov_len = 3;
+    iov[1].iov_base = (void*) "def\n";
+    iov[1].iov_len = 4;
+    twait { f.write(iov, 2, n, make_event(ret)); }
+    printf("writev %d %d\n", (int) n, ret);
+    twait { f.close(make_event(ret)); }
+
+    // read it back
+    twait { tamer::fd::open(fn.c_str(), O_RDONLY, make_event(f)); }
+    twait { f.fstat(st, make_event(ret)); }
+    printf("fstat %d %d\n", ret, (int) st.st_size);
+    twait { f.read(buf, 7, n, make_event(ret)); }
+    printf("read %d %d %.7s\n", (int) n, ret, buf);
+    twait { f.read_once(buf, 40, n, make_event(ret)); }
+    printf("read_once %d %d %.*s", (int) n, ret, (int) n, buf);
+    twait { f.read(buf, 40, n, make_event(ret)); }
+    printf("eof %d %d\n", (int) n, ret);
+
+    // independent file descriptors read in parallel
+    twait { tamer::fd::open(fn.c_str(), O_RDONLY, make_event(g)); }
+    twait { tamer::fd::open(fn.c_str(), O_RDONLY, make_event(f)); }
+    twait {
+        f.read(buf, 14, n, make_event(ret));
+        g.read(buf2, 18, n2, make_event(ret2));
+    }
+    printf("parallel %d %d %.14s %d %d %.18s\n", (int) n, ret, buf,
+           (int) n2, ret2, buf2);
+
+    // positional reads run concurrently and leave the position alone
+    twait {
+        f.pread(buf, 5, 7, n, make_event(ret));
+        f.pread(buf2, 3, 14, n2, make_event(ret2));
+    }
+    printf("pread %d %d %.5s %d %d %.3s\n", (int) n, ret, buf,
+           (int) n2, ret2, buf2);
+    twait { f.read(buf, 4, n, make_event(ret)); }
+    printf("read %d %d %.4s\n", (int) n, ret, buf);
+    iov[0].iov_base = buf;
+    iov[0].iov_len = 2;
+    iov[1].iov_base = buf2;
+    iov[1].iov_len = 40;
+    twait { f.pread(iov, 2, 17, n, make_event(ret)); }
+    printf("preadv %d %d %.2s %.1s\n", (int) n, ret, buf, buf2);
+
+    twait { tamer::fd::open(fn.c_str(), O_WRONLY, make_event(g)); }
+    twait { g.pwrite("DEF", 3, 17, n, make_event(ret)); }
+    twait { f.pread(buf, 40, 14, n, make_event(ret2)); }
+    printf("pwrite %d %d %.*s", ret, ret2, (int) n, buf);
+    twait { f.pwrite("x", 1, -1, n, make_event(ret)); }
+    printf("pwrite %s\n", strerror(-ret));
+
+    // a canceled read does not touch the caller's memory
+    twait { tamer::fd::open(fn.c_str(), O_RDONLY, make_event(g)); }
+    memset(buf, '.', 40);
+    e = make_event(rv, ret);
+    g.read(buf, 40, n, e);
+    e.trigger(-ECANCELED);
+    twait { g.read(buf2, 1, n2, make_event(ret2)); }
+    printf("canceled %d %d %c %d\n", ret, (int) n, buf[0], ret2);
+
+    // close() keeps the descriptor open for writes in flight
+    twait { tamer::fd::open(fn.c_str(), O_WRONLY | O_APPEND, make_event(g)); }
+    twait {
+        g.write("xyz", 3, make_event(ret));
+        g.close();
+    }
+    ::stat(fn.c_str(), &st);
+    printf("close during write %d %d %d\n", ret, g.valid(), (int) st.st_size);
+    twait { tamer::fd::open(fn.c_str(), O_WRONLY, make_event(g)); }
+    twait {
+        g.pwrite("XYZ", 3, 24, make_event(ret));
+        g.close();
+    }
+    ::stat(fn.c_str(), &st);
+    printf("close during pwrite %d %d %d\n", ret, g.valid(), (int) st.st_size);
+
+    unlink(fn.c_str());
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    char fn[100];
+    sprintf(fn, "/tmp/tamer-t17-%d", (int) getpid());
+    test_file(fn);
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
@@ -0,0 +1,81 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/mappedfile.hh>
+using namespace tamer;
+
+tamed void test_mapped(std::string fn) {
+    tvars { tamer::mapped_file mf; tamer::fd rfd, wfd; int ret, ret2;
+        size_t n, n2; char buf[100]; }
+
+    twait { tamer::mapped_file::open("/nonexistent/t18", make_event(mf)); }
+    printf("open %d %s\n", mf.valid(), strerror(-mf.error()));
+    twait { tamer::mapped_file::open("/tmp", make_event(mf)); }
+    printf("open %d %s\n", mf.valid(), strerror(-mf.error()));
+
+    twait { tamer::mapped_file::open(fn.c_str(), make_event(mf)); }
+    printf("open %d %d %.*s", mf.valid(), (int) mf.size(),
+           (int) mf.size(), mf.data());
+    twait { mf.prefetch(make_event()); }
+    twait { mf.prefetch(6, 1000, make_event()); }
+    printf("prefetch\n");
+
+    // write to a socket, then to a pipe
+    {
+        int sv[2];
+        int r = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+        assert(r == 0);
+        tamer::fd::make_nonblocking(sv[0]);
+        tamer::fd::make_nonblocking(sv[1]);
+        rfd = tamer::fd(sv[0]);
+        wfd = tamer::fd(sv[1]);
+    }
+    twait {
+        mf.write(wfd, 6, 5, n, make_event(ret));
+        rfd.read(buf, 5, n2, make_event(ret2));
+    }
+    printf("socket %d %d %d %d %.5s\n", (int) n, ret, (int) n2, ret2, buf);
+
+    tamer::fd::pipe(rfd, wfd);
+    twait {
+        mf.write(wfd, 0, 1000, n, make_event(ret));
+        rfd.read(buf, 13, n2, make_event(ret2));
+    }
+    printf("pipe %d %d %d %d %.13s", (int) n, ret, (int) n2, ret2, buf);
+
+    mf = tamer::mapped_file();
+    twait { mf.write(wfd, n, make_event(ret)); }
+    printf("invalid %s\n", strerror(-ret));
+
+    unlink(fn.c_str());
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    char fn[100];
+    sprintf(fn, "/tmp/tamer-t18-%d", (int) getpid());
+    FILE* f = fopen(fn, "w");
+    fputs("Hello world!\n", f);
+    fclose(f);
+    test_mapped(fn);
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
@@ -0,0 +1,98 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/proxy.hh>
+using namespace tamer;
+
+enum { bigsize = 1 << 20 };
+
+static void make_pair(tamer::fd& x, tamer::fd& y) {
+    int sv[2];
+    int r = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(r == 0);
+    tamer::fd::make_nonblocking(sv[0]);
+    tamer::fd::make_nonblocking(sv[1]);
+    x = tamer::fd(sv[0]);
+    y = tamer::fd(sv[1]);
+}
+
+tamed void test_proxy() {
+    tvars { tamer::fd c0, c1, s0, s1; tamer::proxy_stats stats;
+        tamer::rendezvous<> r; int ret = 1, ret2, ret3; size_t n, n2;
+        char buf[100]; std::string out, in; }
+
+    make_pair(c0, c1);
+    make_pair(s0, s1);
+    tamer::proxy(c1, s0, stats, make_event(r, ret));
+
+    twait {
+        c0.write("hello", 5, make_event(ret2));
+        s1.read(buf, 5, n, make_event(ret3));
+    }
+    printf("a->b %d %d %.5s\n", ret2, ret3, buf);
+    twait {
+        s1.write("world!", 6, make_event(ret2));
+        c0.read(buf, 6, n, make_event(ret3));
+    }
+    printf("b->a %d %d %.6s\n", ret2, ret3, buf);
+
+    // more data than fits in the buffers
+    out = std::string(bigsize, 'x');
+    for (size_t i = 0; i < out.length(); i += 1000)
+        out[i] = 'a' + (i / 1000) % 26;
+    in = std::string(bigsize, '\0');
+    twait {
+        c0.write(out, make_event(ret2));
+        s1.read(&in[0], bigsize, n, make_event(ret3));
+    }
+    printf("big %d %d %d %d\n", ret2, ret3, (int) n, in == out);
+
+    // half-close in one direction leaves the other open
+    c0.shutdown(SHUT_WR);
+    twait { s1.read(buf, 10, n, make_event(ret3)); }
+    printf("eof %d %d\n", ret3, (int) n);
+    twait {
+        s1.write("bye", 3, make_event(ret2));
+        c0.read(buf, 3, n, make_event(ret3));
+    }
+    printf("b->a %d %d %.3s\n", ret2, ret3, buf);
+    printf("proxy %d\n", ret);
+
+    s1.shutdown(SHUT_WR);
+    twait(r);
+    twait { c0.read(buf, 10, n, make_event(ret3)); }
+    printf("proxy %d eof %d %d\n", ret, ret3, (int) n);
+    printf("stats %d %d %d\n", (int) stats.a_to_b.bytes,
+           (int) stats.b_to_a.bytes,
+           stats.a_to_b.bursts > 0 && stats.b_to_a.bursts > 0
+           && stats.a_to_b.latency_max >= stats.a_to_b.latency_mean());
+
+    // errors close both sides
+    make_pair(s0, s1);
+    twait { tamer::proxy(tamer::fd(), s0, stats, make_event(ret)); }
+    printf("proxy %s %d\n", strerror(-ret), (bool) s0);
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    test_proxy();
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
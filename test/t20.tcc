@@ -0,0 +1,107 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <vector>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/connpool.hh>
+using namespace tamer;
+
+std::vector<tamer::fd> accepted;
+
+tamed void server(tamer::fd listenfd) {
+    tvars { tamer::fd cfd; }
+    while (listenfd) {
+        twait { listenfd.accept(make_event(cfd)); }
+        if (cfd)
+            accepted.push_back(cfd);
+    }
+}
+
+void print_stats(const char* what, const tamer::connection_pool& pool) {
+    printf("%s: idle %d connects %d reuses %d stale %d expired %d accepted %d\n",
+           what, (int) pool.idle_count(), (int) pool.stats().connects,
+           (int) pool.stats().reuses, (int) pool.stats().stale,
+           (int) pool.stats().expired, (int) accepted.size());
+}
+
+tamed void test_pool(tamer::fd listenfd, int port) {
+    tvars { tamer::connection_pool pool(2, 0.2); struct in_addr addr;
+        tamer::fd a, b, c, d; int aval; tamer::event<tamer::fd> e; }
+    addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    twait { pool.checkout(addr, port, make_event(a)); }
+    aval = a.value();
+    pool.checkin(addr, port, a);
+    print_stats("checkin", pool);
+
+    twait { pool.checkout(addr, port, make_event(b)); }
+    printf("reuse %d\n", b.value() == aval);
+    twait { pool.checkout(addr, port, make_event(c)); }
+    print_stats("second", pool);
+
+    // a third checkout waits for a checkin
+    twait {
+        pool.checkout(addr, port, make_event(d));
+        printf("waiting\n");
+        pool.checkin(addr, port, b);
+    }
+    printf("waited %d\n", d.value() == aval);
+    pool.checkin(addr, port, c);
+    pool.checkin(addr, port, d);
+    print_stats("both", pool);
+
+    // connections closed by the peer are not reused
+    for (size_t i = 0; i < accepted.size(); ++i)
+        accepted[i].close();
+    twait { tamer::at_delay_msec(20, make_event()); }
+    twait { pool.checkout(addr, port, make_event(a)); }
+    printf("fresh %d\n", (bool) a);
+    pool.checkin(addr, port, a);
+    print_stats("stale", pool);
+
+    // idle connections expire
+    twait { tamer::at_delay_msec(300, make_event()); }
+    print_stats("expire", pool);
+
+    // an abandoned checkout leaves its new connection idle
+    twait {
+        e = make_event(b);
+        pool.checkout(addr, port, e);
+        e.trigger(tamer::fd());
+    }
+    twait { tamer::at_delay_msec(20, make_event()); }
+    print_stats("abandoned", pool);
+
+    listenfd.close();
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    tamer::fd listenfd = tamer::tcp_listen(0);
+    struct sockaddr_in sin;
+    socklen_t sinlen = sizeof(sin);
+    int r = getsockname(listenfd.value(), (struct sockaddr*) &sin, &sinlen);
+    assert(r == 0);
+    server(listenfd);
+    test_pool(listenfd, ntohs(sin.sin_port));
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
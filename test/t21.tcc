@@ -0,0 +1,110 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <vector>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+using namespace tamer;
+
+int naccepted = 0;
+
+tamed void serve(tamer::fd cfd) {
+    tvars { tamer::buffer buf; std::string str; int ret; }
+    twait { buf.take_until(cfd, '\n', 1024, str, make_event(ret)); }
+    if (ret == 0)
+        printf("server got %s", str.c_str());
+}
+
+tamed void server(tamer::fd listenfd, bool reply) {
+    tvars { tamer::fd cfd; }
+    while (listenfd) {
+        twait { listenfd.accept(make_event(cfd)); }
+        if (cfd) {
+            ++naccepted;
+            if (reply)
+                serve(cfd);
+        }
+    }
+}
+
+tamer::fd make_listener(struct sockaddr_in& saddr) {
+    tamer::fd f = tamer::tcp_listen(0);
+    assert(f);
+    socklen_t saddr_len = sizeof(saddr);
+    int r = getsockname(f.value(), (struct sockaddr*) &saddr, &saddr_len);
+    assert(r == 0);
+    saddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return f;
+}
+
+tamed void test_connect() {
+    tvars { tamer::fd lfd, lfd2, f; struct sockaddr_in saddr, saddr2;
+        std::vector<struct sockaddr_in> addrs; std::vector<tamer::fd> fds;
+        int i, nvalid = 0; }
+
+    lfd = make_listener(saddr);
+    lfd.set_socket_profile(tamer::socket_profile().fastopen(16));
+    server(lfd, true);
+    for (i = 0; i < 2; ++i) {
+        twait {
+            tamer::tcp_connect_send(saddr.sin_addr, ntohs(saddr.sin_port),
+                                    "Hello\n", 6, make_event(f));
+        }
+        twait { tamer::at_delay_msec(20, make_event()); }
+        printf("connect_send %d\n", (bool) f);
+    }
+
+    // a closed port
+    lfd2 = make_listener(saddr2);
+    lfd2.close();
+    twait {
+        tamer::tcp_connect_send(saddr2.sin_addr, ntohs(saddr2.sin_port),
+                                "Hello\n", 6, make_event(f));
+    }
+    printf("connect_send %s\n", strerror(-f.error()));
+    twait {
+        tamer::tcp_connect_send(saddr2.sin_addr, ntohs(saddr2.sin_port),
+                                "", 0, make_event(f));
+    }
+    printf("connect_send empty %s\n", strerror(-f.error()));
+
+    // many connects, at most 4 at a time
+    lfd.close();
+    naccepted = 0;
+    lfd = make_listener(saddr);
+    server(lfd, false);
+    for (i = 0; i < 20; ++i)
+        addrs.push_back(i == 10 ? saddr2 : saddr);
+    twait { tamer::tcp_connect_parallel(addrs, 4, fds, make_event()); }
+    for (i = 0; i < (int) fds.size(); ++i)
+        nvalid += (bool) fds[i];
+    twait { tamer::at_delay_msec(20, make_event()); }
+    printf("parallel %d %d %d %s\n", (int) fds.size(), nvalid, naccepted,
+           strerror(-fds[10].error()));
+    lfd.close();
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    test_connect();
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
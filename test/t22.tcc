@@ -0,0 +1,83 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <vector>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+using namespace tamer;
+
+enum { npipes = 300 };
+
+tamed void test_transfer() {
+    tvars { tamer::fd a, b; std::vector<tamer::fd> rfds, wfds, got;
+        int ret, ret2, i, nok = 0; size_t n; char buf[100];
+        int three[3]; }
+
+    {
+        int sv[2];
+        int r = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+        assert(r == 0);
+        tamer::fd::make_nonblocking(sv[0]);
+        tamer::fd::make_nonblocking(sv[1]);
+        a = tamer::fd(sv[0]);
+        b = tamer::fd(sv[1]);
+    }
+    for (i = 0; i < npipes; ++i) {
+        tamer::fd r, w;
+        tamer::fd::pipe(r, w);
+        rfds.push_back(r);
+        wfds.push_back(w);
+    }
+
+    // one message with a payload and several descriptors
+    for (i = 0; i < 3; ++i)
+        three[i] = rfds[i].value();
+    twait {
+        a.sendmsg("abc", 3, three, 3, make_event(ret));
+        b.recvmsg(buf, sizeof(buf), n, got, make_event(ret2));
+    }
+    printf("recvmsg %d %d %.*s %d\n", ret, ret2, (int) n, buf, (int) got.size());
+
+    // more descriptors than fit in one message
+    twait {
+        tamer::send_fds(a, rfds, make_event(ret));
+        tamer::receive_fds(b, got, make_event(ret2));
+    }
+    printf("receive_fds %d %d %d\n", ret, ret2, (int) got.size());
+    for (i = 0; i < npipes; ++i) {
+        sprintf(buf, "%d", i);
+        twait { wfds[i].write(buf, strlen(buf), make_event(ret)); }
+        memset(buf, 0, 10);
+        twait { got[i].read_once(buf, 10, n, make_event(ret)); }
+        if (atoi(buf) == i && got[i].value() != rfds[i].value())
+            ++nok;
+    }
+    printf("match %d\n", nok);
+
+    a.close();
+    twait { tamer::receive_fds(b, got, make_event(ret)); }
+    printf("closed %s\n", strerror(-ret));
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    test_transfer();
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
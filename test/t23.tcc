@@ -0,0 +1,76 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <vector>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+using namespace tamer;
+
+enum { nchildren = 50 };
+
+tamed void test_exec() {
+    tvars { tamer::fd in, out; std::vector<const char*> args;
+        pid_t pid; int status, ret, i, nok = 0; size_t n; char buf[100];
+        tamer::rendezvous<> r; std::vector<int> statuses; }
+
+    // output through a pipe
+    args.push_back("echo");
+    args.push_back("Hello");
+    pid = tamer::execvp(in, out, "echo", args);
+    twait {
+        out.read(buf, 6, n, make_event(ret));
+        tamer::exec_wait(pid, make_event(status));
+    }
+    printf("echo %d %.*s", ret, (int) n, buf);
+    printf("status %d %d\n", WIFEXITED(status), WEXITSTATUS(status));
+
+    // exit status
+    args.clear();
+    args.push_back("sh");
+    args.push_back("-c");
+    args.push_back("exit 3");
+    pid = tamer::execvp(in, out, "sh", args);
+    twait { tamer::exec_wait(pid, make_event(status)); }
+    printf("status %d %d\n", WIFEXITED(status), WEXITSTATUS(status));
+
+    // many children at once
+    args.clear();
+    args.push_back("true");
+    statuses.assign(nchildren, -1);
+    for (i = 0; i < nchildren; ++i) {
+        pid = tamer::execvp(in, out, "true", args);
+        tamer::exec_wait(pid, make_event(r, statuses[i]));
+    }
+    while (r.has_waiting())
+        twait(r);
+    for (i = 0; i < nchildren; ++i)
+        if (statuses[i] == 0)
+            ++nok;
+    printf("children %d\n", nok);
+
+    // already reaped
+    twait { tamer::exec_wait(pid, make_event(status)); }
+    printf("reaped %s\n", strerror(-status));
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    test_exec();
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
@@ -0,0 +1,111 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <tamer/tamer.hh>
+#include <tamer/fs.hh>
+using namespace tamer;
+
+tamed void test_fs(std::string dn) {
+    tvars { struct stat st; int ret, i; tamer::fd f; tamer::fs::dir d;
+        std::vector<std::string> names; char buf[200]; }
+
+    twait { tamer::fs::mkdir(dn, 0777, make_event(ret)); }
+    printf("mkdir %d\n", ret);
+    twait { tamer::fs::mkdir(dn, 0777, make_event(ret)); }
+    printf("mkdir %s\n", strerror(-ret));
+    twait { tamer::fs::stat(dn, st, make_event(ret)); }
+    printf("stat %d %d\n", ret, S_ISDIR(st.st_mode));
+    twait { tamer::fs::stat(dn + "/x", st, make_event(ret)); }
+    printf("stat %s\n", strerror(-ret));
+
+    for (i = 0; i < 5; ++i) {
+        sprintf(buf, "%s/f%d", dn.c_str(), i);
+        twait { tamer::fd::open(buf, O_WRONLY | O_CREAT, 0666, make_event(f)); }
+        twait { f.write("Hello\n", 6, make_event(ret)); }
+        twait { tamer::fs::fdatasync(f, make_event(ret)); }
+        if (ret != 0)
+            printf("fdatasync %d\n", ret);
+        twait { tamer::fs::fsync(f, make_event(ret)); }
+        if (ret != 0)
+            printf("fsync %d\n", ret);
+        f.close();
+    }
+    twait { tamer::fs::fsync(f, make_event(ret)); }
+    printf("fsync %s\n", strerror(-ret));
+
+    // closing during an fsync defers the close, so the number isn't reused
+    sprintf(buf, "%s/h", dn.c_str());
+    f = tamer::fd::open(buf, O_WRONLY | O_CREAT, 0666);
+    twait {
+        tamer::fs::fsync(f, make_event(ret));
+        i = f.value();
+        f.close();
+        int x = ::open(buf, O_RDONLY);
+        printf("fsync reuse %d\n", x == i);
+        ::close(x);
+    }
+    printf("fsync after close %d\n", ret);
+    ::unlink(buf);
+
+    twait { tamer::fs::rename(dn + "/f0", dn + "/g0", make_event(ret)); }
+    printf("rename %d\n", ret);
+    twait { tamer::fs::lstat(dn + "/g0", st, make_event(ret)); }
+    printf("lstat %d %d\n", ret, (int) st.st_size);
+
+    twait { tamer::fs::opendir(dn + "/x", make_event(d)); }
+    printf("opendir %d %s\n", d.valid(), strerror(-d.error()));
+    twait { tamer::fs::opendir(dn, make_event(d)); }
+    printf("opendir %d\n", d.valid());
+    do {
+        twait { d.read(names, 2, make_event(ret)); }
+        printf("read %d\n", ret);
+    } while (ret > 0);
+    std::sort(names.begin(), names.end());
+    for (i = 0; i < (int) names.size(); ++i)
+        printf("%s%s", i ? " " : "", names[i].c_str());
+    printf("\n");
+    d.close();
+    twait { d.read(names, 2, make_event(ret)); }
+    printf("read %s\n", strerror(-ret));
+
+    for (i = 0; i < (int) names.size(); ++i)
+        twait { tamer::fs::unlink(dn + "/" + names[i], make_event(ret)); }
+    twait { tamer::fs::rmdir(dn, make_event(ret)); }
+    printf("rmdir %d\n", ret);
+    twait { tamer::fs::stat(dn, st, make_event(ret)); }
+    printf("stat %s\n", strerror(-ret));
+
+    for (i = 0; i < tamer::fs::nop_types; ++i) {
+        const tamer::fs::op_stats& s = tamer::fs::stats((tamer::fs::op_type) i);
+        printf("%s %d %d %d\n", tamer::fs::op_name((tamer::fs::op_type) i),
+               (int) s.count, (int) s.errors,
+               s.latency_max >= s.latency_mean() && s.latency_mean() >= 0);
+    }
+    tamer::fs::clear_stats();
+    printf("clear %d\n", (int) tamer::fs::stats(tamer::fs::op_stat).count);
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    char dn[100];
+    sprintf(dn, "/tmp/tamer-t24-%d", (int) getpid());
+    test_fs(dn);
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
@@ -0,0 +1,107 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/logwriter.hh>
+using namespace tamer;
+
+tamed void test_log(std::string fn) {
+    tvars { tamer::fd f; tamer::log_writer* lw; int i, ret[10], nok;
+        double start; char buf[100]; struct stat st; }
+
+    twait { tamer::fd::open(fn.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0666,
+                            make_event(f)); }
+
+    // concurrent appends share syncs
+    lw = new tamer::log_writer(f);
+    twait {
+        for (i = 0; i < 10; ++i) {
+            sprintf(buf, "record %d\n", i);
+            lw->append(buf, strlen(buf), make_event(ret[i]));
+        }
+    }
+    for (i = nok = 0; i < 10; ++i)
+        nok += ret[i] == 0;
+    printf("append %d %d %d %d %d\n", nok, (int) lw->stats().records,
+           (int) lw->stats().bytes, lw->stats().batches < 10,
+           (int) lw->pending());
+
+    // flush with nothing pending
+    twait { lw->flush(make_event(ret[0])); }
+    printf("flush %d\n", ret[0]);
+
+    // flush skips the delay
+    delete lw;
+    lw = new tamer::log_writer(f, 10);
+    start = tamer::dnow();
+    twait {
+        lw->append(std::string("delayed\n"), make_event(ret[0]));
+        lw->flush(make_event(ret[1]));
+    }
+    printf("flush %d %d %d\n", ret[0], ret[1], tamer::dnow() - start < 5);
+
+    // a full batch skips the delay
+    delete lw;
+    lw = new tamer::log_writer(f, 10, 20);
+    start = tamer::dnow();
+    twait {
+        for (i = 0; i < 4; ++i)
+            lw->append("0123456789\n", 11, make_event(ret[i]));
+    }
+    printf("batch %d %d %d %d %d %d\n", ret[0], ret[1], ret[2], ret[3],
+           tamer::dnow() - start < 5, (int) lw->stats().batches);
+    delete lw;
+
+    fstat(f.value(), &st);
+    printf("size %d\n", (int) st.st_size);
+
+    // closing during a batch defers the close, so the number isn't reused
+    lw = new tamer::log_writer(f);
+    twait {
+        lw->append("z\n", 2, make_event(ret[0]));
+        i = f.value();
+        f.close();
+        nok = ::open(fn.c_str(), O_RDONLY);
+        printf("close reuse %d\n", nok == i);
+        ::close(nok);
+    }
+    printf("close %s\n", strerror(-ret[0]));
+    delete lw;
+
+    // errors are sticky
+    twait { tamer::fd::open(fn.c_str(), O_RDONLY, 0, make_event(f)); }
+    lw = new tamer::log_writer(f);
+    twait { lw->append("x\n", 2, make_event(ret[0])); }
+    twait { lw->append("y\n", 2, make_event(ret[1])); }
+    printf("error %s %s %s\n", strerror(-ret[0]), strerror(-ret[1]),
+           strerror(-lw->error()));
+    delete lw;
+
+    unlink(fn.c_str());
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    char fn[100];
+    sprintf(fn, "/tmp/tamer-t25-%d", (int) getpid());
+    test_log(fn);
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
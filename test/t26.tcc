@@ -0,0 +1,63 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+using namespace tamer;
+
+int get_option(const tamer::fd& f, int level, int name) {
+    int val = -1;
+    socklen_t len = sizeof(val);
+    getsockopt(f.value(), level, name, &val, &len);
+    return val;
+}
+
+tamed void test_profile() {
+    tvars { tamer::fd l, c, a; struct sockaddr_in sin; socklen_t sinlen;
+        int r; }
+
+    l = tamer::tcp_listen(0);
+    printf("empty %d\n", tamer::socket_profile().empty());
+    r = l.set_socket_profile(tamer::socket_profile().nodelay()
+                             .receive_buffer(32768).quickack());
+    printf("listener %d %d\n", r,
+           get_option(l, IPPROTO_TCP, TCP_NODELAY) != 0);
+
+    sinlen = sizeof(sin);
+    getsockname(l.value(), (struct sockaddr*) &sin, &sinlen);
+    twait {
+        tamer::tcp_connect(sin.sin_addr, ntohs(sin.sin_port), make_event(c));
+        l.accept(make_event(a));
+    }
+    printf("accepted %d %d %d\n", a.valid(),
+           get_option(a, IPPROTO_TCP, TCP_NODELAY) != 0,
+           get_option(a, SOL_SOCKET, SO_RCVBUF)
+           == get_option(l, SOL_SOCKET, SO_RCVBUF));
+    printf("connected %d\n", get_option(c, IPPROTO_TCP, TCP_NODELAY) != 0);
+
+    printf("invalid %d\n", tamer::fd().set_socket_profile(tamer::socket_profile()));
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    test_profile();
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
@@ -0,0 +1,108 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/stream.hh>
+using namespace tamer;
+
+tamed void drain(tamer::fd f, size_t& total, tamer::event<> done) {
+    tvars { char buf[4096]; size_t n; int r; }
+    do {
+        twait { f.read_once(buf, sizeof(buf), n, make_event(r)); }
+        total += n;
+    } while (r == 0 && n != 0);
+    done.trigger();
+}
+
+tamed void test_stream() {
+    tvars { tamer::fd a, b; tamer::stream* s; std::string str(4096, 'x');
+        int i, r; size_t total = 0, n; char buf[100];
+        ref_ptr<tamer::stream::chunk> c; tamer::rendezvous<> rv; }
+
+    {
+        int sv[2];
+        int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+        assert(x == 0);
+        tamer::fd::make_nonblocking(sv[0]);
+        tamer::fd::make_nonblocking(sv[1]);
+        a = tamer::fd(sv[0]);
+        b = tamer::fd(sv[1]);
+    }
+    s = new tamer::stream(a, 20000, 5000);
+
+    // fill until the high watermark
+    for (i = 0; s->write(str); ++i)
+        /* do nothing */;
+    printf("blocked %d %d\n", s->writable(), s->queued() >= 20000);
+    drain(b, total, make_event(rv));
+    twait { s->wait_writable(make_event()); }
+    printf("writable %d %d\n", s->writable(), s->queued() <= 5000);
+
+    // shared chunks
+    c = ref_ptr<tamer::stream::chunk>(new tamer::stream::chunk("shared\n"));
+    s->write(c);
+    s->write(c);
+    twait { s->flush(make_event(r)); }
+    printf("flush %d %d\n", r, (int) s->queued());
+
+    // half-close
+    twait { s->shutdown_write(make_event(r)); }
+    printf("shutdown %d %d\n", r, s->write("late", 4));
+    twait(rv);
+    printf("drained %d\n", total == (i + 1) * str.length() + 14);
+
+    // the read half stays open
+    twait { b.write("hello\nworld", 11, make_event()); }
+    b.close();
+    twait { s->take_until('\n', 100, str, make_event(r)); }
+    printf("take %d %s", r, str.c_str());
+    twait { s->read_once(buf, sizeof(buf), n, make_event(r)); }
+    printf("read %d %.*s\n", r, (int) n, buf);
+    twait { s->read_once(buf, sizeof(buf), n, make_event(r)); }
+    printf("read %d %d %d\n", r, (int) n, s->read_closed());
+
+    s->close();
+    printf("close %d %s\n", s->write("x", 1), strerror(-s->write_error()));
+    delete s;
+
+    // the fd's write deadline applies to queued output
+    {
+        int sv[2];
+        int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+        assert(x == 0);
+        tamer::fd::make_nonblocking(sv[0]);
+        a = tamer::fd(sv[0]);
+        b = tamer::fd(sv[1]);
+    }
+    a.set_write_deadline(tamer::dnow() + 0.05);
+    s = new tamer::stream(a, 20000, 5000);
+    str = std::string(4096, 'x');
+    for (i = 0; i != 256; ++i)
+        s->write(str);
+    twait { s->flush(make_event(r)); }
+    printf("deadline %d\n", r == tamer::outcome::timeout);
+    delete s;
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    test_stream();
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
@@ -0,0 +1,87 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+using namespace tamer;
+
+// Lines of every length from 0 to 199 bytes, read through a small ring so
+// the delimiter lands at every offset and position relative to the wrap.
+
+std::string make_line(int i) {
+    std::string s;
+    for (int j = 0; j < i % 200; ++j)
+        s += (char) ('a' + (i + j) % 26);
+    return s + '\n';
+}
+
+tamed void writer(tamer::fd f) {
+    tvars { std::string all; size_t pos = 0, n; int i, r = 0; }
+    for (i = 0; i < 1000; ++i)
+        all += make_line(i);
+    for (i = 1; pos < all.length() && r == 0; i = i % 97 + 13) {
+        n = std::min(all.length() - pos, (size_t) i);
+        twait { f.write(all.data() + pos, n, make_event(r)); }
+        pos += n;
+    }
+    f.close();
+}
+
+tamed void reader(tamer::fd f) {
+    tvars { tamer::buffer buf(16); std::string line; int i = 0, bad = 0, r; }
+    while (1) {
+        twait { buf.take_until(f, '\n', 1000, line, make_event(r)); }
+        if (r != 0)
+            break;
+        if (line != make_line(i))
+            ++bad;
+        ++i;
+    }
+    printf("lines %d bad %d\n", i, bad);
+
+    twait { buf.take_until(f, '\n', 10, line, make_event(r)); }
+    printf("closed %d\n", r == tamer::outcome::closed);
+}
+
+tamed void toolong(tamer::fd rf, tamer::fd wf) {
+    tvars { tamer::buffer buf(16); std::string line; int r; }
+    twait { wf.write("0123456789abcdef\n", 17, make_event(r)); }
+    twait { buf.take_until(rf, '\n', 10, line, make_event(r)); }
+    printf("toolong %d\n", r == -E2BIG);
+    twait { buf.take_until(rf, '\n', 17, line, make_event(r)); }
+    printf("fits %d %s", r, line.c_str());
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    int sv[2];
+    int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(x == 0);
+    tamer::fd::make_nonblocking(sv[0]);
+    tamer::fd::make_nonblocking(sv[1]);
+    writer(tamer::fd(sv[0]));
+    reader(tamer::fd(sv[1]));
+    tamer::loop();
+
+    tamer::fd rf, wf;
+    tamer::fd::pipe(rf, wf);
+    toolong(rf, wf);
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
@@ -0,0 +1,84 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+using namespace tamer;
+
+const char request[] = "GET / HTTP/1.1\r\nHost: x\r\n\r\n"
+    "GET /a HTTP/1.1\r\n\r\nkey=value;k2=v2\n\r\r\n\r";
+
+void print_escaped(const char* prefix, int r, const std::string& s) {
+    printf("%s %d ", prefix, r);
+    for (size_t i = 0; i != s.length(); ++i)
+        if (s[i] == '\r')
+            printf("\\r");
+        else if (s[i] == '\n')
+            printf("\\n");
+        else
+            putchar(s[i]);
+    printf("\n");
+}
+
+// Write one byte at a time so delimiters arrive split across reads.
+tamed void writer(tamer::fd f) {
+    tvars { size_t i; int r = 0; }
+    for (i = 0; i != sizeof(request) - 1 && r == 0; ++i) {
+        twait { f.write(request + i, 1, make_event(r)); }
+        twait { tamer::at_asap(make_event()); }
+    }
+    f.close();
+}
+
+tamed void reader(tamer::fd f) {
+    tvars { tamer::buffer buf(8); std::string s; int r; }
+    twait { buf.take_until(f, "\r\n\r\n", 100, s, make_event(r)); }
+    print_escaped("header", r, s);
+    twait { buf.take_until(f, "\r\n\r\n", 10, s, make_event(r)); }
+    print_escaped("toolong", r == -E2BIG, s);
+    twait { buf.take_until(f, "\r\n\r\n", 100, s, make_event(r)); }
+    print_escaped("header", r, s);
+    twait { buf.take_until_any(f, "=;\n", 100, s, make_event(r)); }
+    print_escaped("any", r, s);
+    twait { buf.take_until_any(f, "=;\n", 100, s, make_event(r)); }
+    print_escaped("any", r, s);
+    twait { buf.take_until_any(f, "=;\n", 100, s, make_event(r)); }
+    print_escaped("any", r, s);
+    twait { buf.take_until_any(f, "=;\n", 100, s, make_event(r)); }
+    print_escaped("any", r, s);
+    twait { buf.take_until(f, "\r\n", 100, s, make_event(r)); }
+    print_escaped("crlf", r, s);
+    twait { buf.take_until(f, "", 100, s, make_event(r)); }
+    print_escaped("empty", r == -EINVAL, s);
+    twait { buf.take_until(f, "\r\n", 100, s, make_event(r)); }
+    print_escaped("eof", r == tamer::outcome::closed, s);
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    int sv[2];
+    int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(x == 0);
+    tamer::fd::make_nonblocking(sv[0]);
+    tamer::fd::make_nonblocking(sv[1]);
+    writer(tamer::fd(sv[0]));
+    reader(tamer::fd(sv[1]));
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
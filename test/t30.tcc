@@ -0,0 +1,78 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+using namespace tamer;
+
+const char input[] = "alpha\nbeta\ngamma delta\nepsilon\nzeta";
+
+void print_view(const char* prefix, int r, const tamer::buffer::view& v) {
+    std::string s = v.str();
+    bool same = true;
+    for (size_t i = 0; i != v.length(); ++i)
+        same = same && v[i] == s[i];
+    printf("%s %d %d ", prefix, r, same);
+    for (size_t i = 0; i != s.length(); ++i)
+        putchar(s[i] == '\n' ? '|' : s[i]);
+    printf("\n");
+}
+
+tamed void reader(tamer::fd f) {
+    tvars {
+        tamer::buffer buf(8);
+        tamer::buffer::view v;
+        int r;
+        bool wrapped = false;
+    }
+    twait { buf.peek_until(f, '\n', 100, v, make_event(r)); }
+    print_view("line", r, v);
+    // peeking again without consuming returns the same data
+    twait { buf.peek_until(f, '\n', 100, v, make_event(r)); }
+    print_view("again", r, v);
+    buf.consume(v.length());
+    while (1) {
+        twait { buf.peek_until(f, '\n', 100, v, make_event(r)); }
+        if (r != 0)
+            break;
+        wrapped = wrapped || !v.contiguous();
+        print_view("line", r, v);
+        buf.consume(v.length());
+    }
+    print_view("eof", r == tamer::outcome::closed, buf.peek());
+    buf.consume(4);
+    print_view("rest", buf.buffered(), buf.peek());
+    twait { buf.peek_until_any(f, " \n", 4, v, make_event(r)); }
+    print_view("closed", r == tamer::outcome::closed, v);
+    printf("wrapped %d\n", wrapped);
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    int sv[2];
+    int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(x == 0);
+    x = write(sv[0], input, sizeof(input) - 1);
+    assert(x == sizeof(input) - 1);
+    close(sv[0]);
+    tamer::fd::make_nonblocking(sv[1]);
+    reader(tamer::fd(sv[1]));
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
@@ -0,0 +1,82 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+using namespace tamer;
+
+// Line i holds (i * 37) % 200 copies of the letter 'a' + i % 26.
+std::string make_line(int i) {
+    return std::string((i * 37) % 200, 'a' + i % 26) + "\n";
+}
+
+tamed void writer(tamer::fd f, std::string s) {
+    tvars { int r; }
+    twait { f.write(s, make_event(r)); }
+    f.close();
+}
+
+tamed void reader(tamer::fd f, tamer::fd g, int nlines) {
+    tvars {
+        tamer::buffer buf(sysconf(_SC_PAGESIZE), true);
+        tamer::buffer small(sysconf(_SC_PAGESIZE) / 4, true);
+        tamer::buffer::view v;
+        int i, r, nbad = 0, nsplit = 0;
+    }
+    printf("mirrored %d\n", buf.mirrored());
+    for (i = 0; i != nlines; ++i) {
+        twait { buf.peek_until(f, '\n', 1000, v, make_event(r)); }
+        if (r != 0 || v.str() != make_line(i))
+            ++nbad;
+        if (!v.contiguous())
+            ++nsplit;
+        buf.consume(v.length());
+    }
+    printf("lines %d bad %d split %d\n", i, nbad, nsplit);
+    twait { buf.peek_until(f, '\n', 1000, v, make_event(r)); }
+    printf("eof %d\n", r == tamer::outcome::closed);
+
+    // a buffer smaller than a page is mirrored once it grows past one
+    printf("small mirrored %d\n", small.mirrored());
+    twait { small.peek_until(g, '\n', 1 << 20, v, make_event(r)); }
+    printf("small %d %d %d\n", r, small.mirrored(),
+           v.length() == (size_t) 3 * sysconf(_SC_PAGESIZE) + 1);
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    int sv[2], sw[2];
+    int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(x == 0);
+    x = socketpair(AF_UNIX, SOCK_STREAM, 0, sw);
+    assert(x == 0);
+    for (int i = 0; i != 2; ++i) {
+        tamer::fd::make_nonblocking(sv[i]);
+        tamer::fd::make_nonblocking(sw[i]);
+    }
+
+    std::string s;
+    for (int i = 0; i != 500; ++i)
+        s += make_line(i);
+    writer(tamer::fd(sv[0]), s);
+    writer(tamer::fd(sw[0]), std::string(3 * sysconf(_SC_PAGESIZE), 'x') + "\n");
+    reader(tamer::fd(sv[1]), tamer::fd(sw[1]), 500);
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
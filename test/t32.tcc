@@ -0,0 +1,73 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+using namespace tamer;
+
+// The reader writes its own input, one message at a time, so that each
+// message needs at least one read.
+tamed void reader(int wfd, tamer::fd f) {
+    tvars {
+        tamer::buffer buf(64);
+        std::string s, line;
+        int i, r, nbad = 0;
+        size_t x;
+    }
+
+    // short messages wrap around the ring
+    for (i = 0; i != 20; ++i) {
+        line = std::string(5 + i % 13, 'a' + i) + "\n";
+        x = write(wfd, line.data(), line.length());
+        assert(x == line.length());
+        twait { buf.take_until(f, '\n', 1000, s, make_event(r)); }
+        if (r != 0 || s != line)
+            ++nbad;
+    }
+    printf("wrapped %d capacity %d\n", nbad, (int) buf.capacity());
+
+    line = std::string(10000, 'x') + "\n";
+    x = write(wfd, line.data(), line.length());
+    assert(x == line.length());
+    twait { buf.take_until(f, '\n', 20000, s, make_event(r)); }
+    printf("large %d %d capacity %d\n", r, s == line, (int) buf.capacity());
+
+    // once messages are small again, the buffer shrinks
+    for (i = 0; i != 100; ++i) {
+        line = std::string(10, 'a' + i % 26) + "\n";
+        x = write(wfd, line.data(), line.length());
+        assert(x == line.length());
+        twait { buf.take_until(f, '\n', 1000, s, make_event(r)); }
+        if (r != 0 || s != line)
+            ++nbad;
+    }
+    printf("small %d capacity %d\n", nbad, (int) buf.capacity());
+    close(wfd);
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    int sv[2];
+    int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(x == 0);
+    tamer::fd::make_nonblocking(sv[1]);
+    reader(sv[0], tamer::fd(sv[1]));
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
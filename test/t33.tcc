@@ -0,0 +1,108 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+#include <tamer/obuffer.hh>
+using namespace tamer;
+
+tamed void reader(tamer::fd f, tamer::event<> done) {
+    tvars { tamer::buffer buf; std::string s; int r, n = 0; size_t total = 0; }
+    while (1) {
+        twait { buf.take_until(f, '\n', 1 << 20, s, make_event(r)); }
+        if (r != 0)
+            break;
+        if (n < 4 || s.length() > 100)
+            printf("read %d %s", (int) s.length(),
+                   s.length() > 100 ? "long\n" : s.c_str());
+        ++n;
+        total += s.length();
+    }
+    printf("read %d lines %d bytes, %d\n", n, (int) total,
+           r == tamer::outcome::closed);
+    done();
+}
+
+tamed void writer(tamer::fd f) {
+    tvars {
+        tamer::obuffer out(f);
+        tamer::obuffer manual(f, 100, false);
+        tamer::obuffer* stuck;
+        tamer::fd g, h;
+        int i, r;
+    }
+
+    // autoflush at the end of the iteration
+    out.printf("hello %d\n", 1);
+    out.append("world\n");
+    printf("pending %d\n", (int) out.pending());
+    twait { tamer::at_asap(make_event()); }
+    twait { tamer::at_asap(make_event()); }
+    printf("pending %d\n", (int) out.pending());
+
+    // threshold and explicit flush
+    manual.append(std::string(49, 'a') + "\n");
+    printf("manual pending %d\n", (int) manual.pending());
+    twait { tamer::at_asap(make_event()); }
+    printf("manual pending %d\n", (int) manual.pending());
+    manual.append(std::string(59, 'b') + "\n");
+    printf("manual pending %d\n", (int) manual.pending());
+    manual.printf("%s\n", "explicit");
+    twait { manual.flush(make_event(r)); }
+    printf("manual flush %d pending %d\n", r, (int) manual.pending());
+
+    // output larger than a chunk, and larger than the socket buffer
+    out.printf("%s\n", std::string(10000, 'x').c_str());
+    for (i = 0; i != 20000; ++i)
+        out.printf("line %05d %s\n", i, "abcdefghijklmnopqrstuvwxyz");
+    twait { out.flush(make_event(r)); }
+    printf("flush %d pending %d error %d\n", r, (int) out.pending(),
+           out.error());
+    f.close();
+
+    // the fd's write deadline applies to buffered output
+    {
+        int sv[2];
+        int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+        assert(x == 0);
+        tamer::fd::make_nonblocking(sv[0]);
+        g = tamer::fd(sv[0]);
+        h = tamer::fd(sv[1]);
+    }
+    g.set_write_deadline(tamer::dnow() + 0.05);
+    stuck = new tamer::obuffer(g);
+    for (i = 0; i != 20000; ++i)
+        stuck->printf("line %05d %s\n", i, "abcdefghijklmnopqrstuvwxyz");
+    twait { stuck->flush(make_event(r)); }
+    printf("deadline %d\n", r == tamer::outcome::timeout);
+    delete stuck;
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    int sv[2];
+    int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(x == 0);
+    tamer::fd::make_nonblocking(sv[0]);
+    tamer::fd::make_nonblocking(sv[1]);
+    writer(tamer::fd(sv[0]));
+    reader(tamer::fd(sv[1]), tamer::event<>());
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
@@ -0,0 +1,90 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+using namespace tamer;
+
+enum { nconn = 100 };
+tamer::buffer* bufs[nconn];
+int sv[nconn][2];
+
+tamed void reader(tamer::buffer& buf, tamer::fd f, tamer::event<> done) {
+    tvars { std::string s; int r; }
+    while (1) {
+        twait { buf.take_until(f, '\n', 1 << 20, s, make_event(r)); }
+        if (r != 0)
+            break;
+    }
+    done();
+}
+
+size_t total_allocated() {
+    size_t total = 0;
+    for (int i = 0; i != nconn; ++i)
+        total += bufs[i]->allocated();
+    return total;
+}
+
+tamed void run() {
+    tvars {
+        tamer::rendezvous<> r;
+        int i, x;
+    }
+    for (i = 0; i != nconn; ++i) {
+        x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv[i]);
+        assert(x == 0);
+        tamer::fd::make_nonblocking(sv[i][1]);
+        bufs[i] = new tamer::buffer;
+        reader(*bufs[i], tamer::fd(sv[i][1]), make_event(r));
+    }
+    twait { tamer::at_asap(make_event()); }
+    printf("idle %d\n", (int) total_allocated());
+
+    // a partial line stays buffered
+    for (i = 0; i != nconn; i += 10) {
+        x = write(sv[i][0], "partial", 7);
+        assert(x == 7);
+    }
+    twait { tamer::at_delay_msec(10, make_event()); }
+    printf("partial %d\n", (int) total_allocated());
+
+    // once the lines complete, the buffers drain and release their memory
+    for (i = 0; i != nconn; i += 10) {
+        x = write(sv[i][0], " line\nwhole line\n", 17);
+        assert(x == 17);
+    }
+    twait { tamer::at_delay_msec(10, make_event()); }
+    printf("drained %d\n", (int) total_allocated());
+
+    for (i = 0; i != nconn; ++i)
+        close(sv[i][0]);
+    while (r.has_waiting())
+        twait(r);
+    printf("closed %d\n", (int) total_allocated());
+    for (i = 0; i != nconn; ++i)
+        delete bufs[i];
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    run();
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
@@ -0,0 +1,115 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <tamer/tamer.hh>
+#include <tamer/fd.hh>
+#include <tamer/bufferedio.hh>
+using namespace tamer;
+
+void put_be(std::string& s, uint64_t x, int width) {
+    for (int i = width - 1; i >= 0; --i)
+        s += char(x >> (8 * i));
+}
+
+void put_varint(std::string& s, uint64_t x) {
+    for (; x >= 0x80; x >>= 7)
+        s += char(x | 0x80);
+    s += char(x);
+}
+
+std::string make_input() {
+    std::string s;
+    put_be(s, 5, 4);
+    s += "hello";
+    put_be(s, 3, 1);
+    s += "abc";
+    put_be(s, 5000, 2);
+    s += std::string(5000, 'x');
+    put_varint(s, 300);
+    s += std::string(300, 'y');
+    put_varint(s, 0);
+    s += "EXACT";
+    put_be(s, 1000, 4);
+    s += std::string(1000, 'z');
+    s += std::string(11, '\x80');
+    return s;
+}
+
+// Write a few bytes at a time so prefixes arrive split across reads.
+tamed void writer(tamer::fd f, std::string s) {
+    tvars { size_t i, n; int r = 0; }
+    for (i = 0; i < s.length() && r == 0; i += n) {
+        n = (s.length() - i < 7 ? s.length() - i : 7);
+        twait { f.write(s.data() + i, n, make_event(r)); }
+        twait { tamer::at_asap(make_event()); }
+    }
+    f.close();
+}
+
+void print_view(const char* prefix, int r, const tamer::buffer::view& v) {
+    std::string s = v.str();
+    printf("%s %d %d", prefix, r, (int) s.length());
+    if (s.length() && s.length() <= 8)
+        printf(" %s", s.c_str());
+    else if (s.length())
+        printf(" %c..%c", s[0], s[s.length() - 1]);
+    printf("\n");
+}
+
+tamed void reader(tamer::fd f) {
+    tvars { tamer::buffer buf(16); tamer::buffer::view v; int r; }
+    twait { buf.take_frame<uint32_t>(f, 100, v, make_event(r)); }
+    print_view("u32", r, v);
+    twait { buf.take_frame<uint8_t>(f, 100, v, make_event(r)); }
+    print_view("u8", r, v);
+    twait { buf.take_frame<uint16_t>(f, 10000, v, make_event(r)); }
+    print_view("u16", r, v);
+    printf("capacity %d\n", (int) buf.capacity());
+    twait { buf.take_frame<tamer::buffer::varint>(f, 1000, v, make_event(r)); }
+    print_view("varint", r, v);
+    twait { buf.take_frame<tamer::buffer::varint>(f, 1000, v, make_event(r)); }
+    print_view("varint", r, v);
+    twait { buf.take_exact(f, 5, v, make_event(r)); }
+    print_view("exact", r, v);
+    twait { buf.take_exact(f, (size_t) -1, v, make_event(r)); }
+    print_view("huge", r == -E2BIG, v);
+    twait { buf.take_frame<uint32_t>(f, 100, v, make_event(r)); }
+    print_view("toobig", r == -E2BIG, v);
+    twait { buf.take_exact(f, 4, v, make_event(r)); }
+    twait { buf.take_exact(f, 1000, v, make_event(r)); }
+    print_view("skipped", r, v);
+    twait { buf.take_frame<tamer::buffer::varint>(f, 1000, v, make_event(r)); }
+    print_view("badvarint", r == -EINVAL, v);
+    twait { buf.take_exact(f, 11, v, make_event(r)); }
+    twait { buf.take_exact(f, 1, v, make_event(r)); }
+    print_view("eof", r == tamer::outcome::closed, v);
+}
+
+int main(int, char *[]) {
+    tamer::initialize();
+    int sv[2];
+    int x = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+    assert(x == 0);
+    tamer::fd::make_nonblocking(sv[0]);
+    tamer::fd::make_nonblocking(sv[1]);
+    writer(tamer::fd(sv[0]), make_input());
+    reader(tamer::fd(sv[1]));
+    tamer::loop();
+    tamer::cleanup();
+    printf("done\n");
+}
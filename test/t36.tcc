@@ -0,0 +1,181 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <tamer/tamer.hh>
+#include <tamer/dns.hh>
+using namespace tamer;
+
+// Header for a response with one question and @a ancount answers.
+void put_header(dns::packet_writer& w, uint16_t ancount) {
+    w << (uint16_t) 0x1234 << (uint16_t) 0x8180 << (uint16_t) 1
+      << ancount << (uint16_t) 0 << (uint16_t) 0;
+}
+
+void put_a(dns::packet_writer& w, const char* name, uint32_t ttl,
+           const char* addr) {
+    struct in_addr ina;
+    inet_aton(addr, &ina);
+    w.write_name(name, strlen(name));
+    w << (uint16_t) TYPE_A << (uint16_t) CLASS_INET << ttl << (uint16_t) 4
+      << ina;
+}
+
+void print_names(const uint8_t* buf, size_t len, int n) {
+    dns::arena a;
+    dns::packet_reader r(buf, len, a);
+    const char* name;
+    size_t namelen;
+    uint16_t type, class_, rdlength;
+    uint32_t ttl;
+    r.skip(12).read_name(name, namelen) >> type >> class_;
+    printf("question %s\n", name);
+    for (int i = 0; r && i != n; ++i) {
+        r.read_name(name, namelen) >> type >> class_ >> ttl >> rdlength;
+        r.skip(rdlength);
+        printf("answer %s %d\n", name, (int) namelen);
+    }
+    printf("reader %d offset %d arena %d\n", !!r, (int) r.offset(),
+           (int) a.used());
+}
+
+void test_compression() {
+    uint8_t buf[512];
+    dns::packet_writer w(buf, sizeof(buf));
+    put_header(w, 4);
+    w.write_name("www.example.com", 15);
+    w << (uint16_t) TYPE_A << (uint16_t) CLASS_INET;
+    put_a(w, "www.example.com.", 300, "10.0.0.1");
+    put_a(w, "WWW.Example.COM", 60, "10.0.0.2");
+    put_a(w, "mail.example.com", 600, "10.0.0.3");
+    put_a(w, "example.org", 600, "10.0.0.4");
+    // 12 header + 17 + 4 question + 4 * 10 fixed + 2 + 2 + 7 + 13 names
+    printf("size %d\n", (int) w.size());
+    print_names(buf, w.size(), 4);
+
+    dns::reply p = dns::make_reply(dns::make_packet(buf, w.size()));
+    printf("reply err %d id %x addrs %d ttl %u\n", p->err, p->trans_id,
+           (int) p->addrs.size(), p->ttl);
+    for (size_t i = 0; i != p->addrs.size(); ++i) {
+        struct in_addr ina;
+        ina.s_addr = p->addrs[i];
+        printf("  %s\n", inet_ntoa(ina));
+    }
+}
+
+// Names compressed after a TCP length prefix point into the message.
+void test_prefixed() {
+    uint8_t buf[512];
+    dns::packet_writer w(buf, sizeof(buf));
+    w << (uint16_t) 0;
+    w.begin_message();
+    put_header(w, 2);
+    w.write_name("www.example.com", 15);
+    w << (uint16_t) TYPE_A << (uint16_t) CLASS_INET;
+    put_a(w, "www.example.com", 300, "10.0.0.1");
+    put_a(w, "mail.example.com", 300, "10.0.0.2");
+    w.patch(0, w.size() - 2);
+    printf("prefixed size %d prefix %d\n", (int) w.size(),
+           (buf[0] << 8) | buf[1]);
+    print_names(buf + 2, w.size() - 2, 2);
+}
+
+void test_ptr() {
+    // the PTR target points into the question
+    uint8_t buf[512];
+    const char* q = "4.3.2.1.in-addr.arpa";
+    dns::packet_writer w(buf, sizeof(buf));
+    put_header(w, 1);
+    w.write_name(q, strlen(q));
+    w << (uint16_t) TYPE_PTR << (uint16_t) CLASS_INET;
+    w.write_name(q, strlen(q));
+    w << (uint16_t) TYPE_PTR << (uint16_t) CLASS_INET << (uint32_t) 100;
+    size_t rdpos = w.size();
+    w << (uint16_t) 0;
+    w.write_name("host.in-addr.arpa", 17);
+    w.patch(rdpos, w.size() - rdpos - 2);
+    dns::reply p = dns::make_reply(dns::make_packet(buf, w.size()));
+    printf("ptr err %d name %s ttl %u size %d\n", p->err, p->name.c_str(),
+           p->ttl, (int) w.size());
+}
+
+void test_malformed() {
+    dns::arena a;
+    const char* name;
+    size_t len;
+
+    // a pointer to itself
+    const uint8_t loop[] = { 3, 'a', 'b', 'c', 0xC0, 4 };
+    dns::packet_reader r1(loop, sizeof(loop), a);
+    r1.skip(4).read_name(name, len);
+    printf("self pointer %d\n", !!r1);
+
+    // a backward pointer to a label sequence that reaches the pointer again
+    const uint8_t cycle[] = { 1, 'x', 0xC0, 0 };
+    dns::packet_reader r2(cycle, sizeof(cycle), a);
+    r2.read_name(name, len);
+    printf("cycle %d\n", !!r2);
+
+    // a truncated label
+    const uint8_t trunc[] = { 5, 'a', 'b' };
+    dns::packet_reader r3(trunc, sizeof(trunc), a);
+    r3.read_name(name, len);
+    printf("truncated %d\n", !!r3);
+
+    // a short read sticks
+    uint32_t x = 0;
+    uint8_t y = 0;
+    dns::packet_reader r4(trunc, sizeof(trunc), a);
+    r4 >> x >> y;
+    printf("short %d %u %u\n", !!r4, x, y);
+
+    // a truncated reply
+    uint8_t buf[512];
+    dns::packet_writer w(buf, sizeof(buf));
+    put_header(w, 1);
+    w.write_name("a.example", 9);
+    w << (uint16_t) TYPE_A << (uint16_t) CLASS_INET;
+    put_a(w, "a.example", 10, "10.1.1.1");
+    dns::reply p = dns::make_reply(dns::make_packet(buf, w.size() - 2));
+    printf("short reply err %d\n", p->err);
+
+    // writer overflow
+    dns::packet_writer w2(buf, 8);
+    w2.write_name("toolong.example", 15);
+    printf("overflow %d size %d\n", !!w2, (int) w2.size());
+    dns::packet_writer w3(buf, sizeof(buf));
+    w3.write_name("a..b", 4);
+    printf("empty label %d\n", !!w3);
+}
+
+void test_request() {
+    dns::request q = dns::make_request_a("www.example.com.");
+    dns::packet p;
+    q->next(0x4242);
+    int r = q->getpacket(p);
+    printf("request %d size %d\n", r, (int) p->size());
+    r = q->getpacket(p, true);
+    printf("tcp request %d size %d prefix %d\n", r, (int) p->size(),
+           (p->getbuf()[0] << 8) | p->getbuf()[1]);
+    print_names(p->getbuf() + 2, p->size() - 2, 0);
+}
+
+int main(int, char *[]) {
+    test_compression();
+    test_prefixed();
+    test_ptr();
+    test_malformed();
+    test_request();
+    printf("done\n");
+}
@@ -0,0 +1,164 @@
+// -*- mode: c++ -*-
+/* Copyright (c) 2013, Eddie Kohler
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, subject to the conditions
+ * listed in the Tamer LICENSE file. These conditions include: you must
+ * preserve this copyright notice, and you cannot mention the copyright
+ * holders in advertising related to the Software without their permission.
+ * The Software is provided WITHOUT ANY WARRANTY, EXPRESS OR IMPLIED. This
+ * notice is a summary of the Tamer LICENSE file; the license in that file is
+ * legally binding.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <tamer/tamer.hh>
+#include <tamer/dns.hh>
+using namespace tamer;
+
+// Build a response for @a name with rcode @a rcode, one A answer if
+// @a ttl is nonzero, and an SOA authority record if @a soa_ttl is nonzero.
+dns::reply make_response(const char* name, int rcode, uint32_t ttl,
+                         uint32_t soa_ttl, uint32_t soa_minimum) {
+    uint8_t buf[512];
+    dns::packet_writer w(buf, sizeof(buf));
+    w << (uint16_t) 0x1234 << (uint16_t) (0x8180 | rcode) << (uint16_t) 1
+      << (uint16_t) (ttl ? 1 : 0) << (uint16_t) (soa_ttl ? 1 : 0)
+      << (uint16_t) 0;
+    w.write_name(name, strlen(name));
+    w << (uint16_t) TYPE_A << (uint16_t) CLASS_INET;
+    if (ttl) {
+        struct in_addr ina;
+        inet_aton("10.0.0.1", &ina);
+        w.write_name(name, strlen(name));
+        w << (uint16_t) TYPE_A << (uint16_t) CLASS_INET << ttl
+          << (uint16_t) 4 << ina;
+    }
+    if (soa_ttl) {
+        w.write_name("example.com", 11);
+        w << (uint16_t) TYPE_SOA << (uint16_t) CLASS_INET << soa_ttl;
+        size_t rdpos = w.size();
+        w << (uint16_t) 0;
+        w.write_name("ns.example.com", 14);
+        w.write_name("admin.example.com", 17);
+        w << (uint32_t) 1 << (uint32_t) 7200 << (uint32_t) 900
+          << (uint32_t) 1209600 << soa_minimum;
+        w.patch(rdpos, w.size() - rdpos - 2);
+    }
+    return dns::make_reply(dns::make_packet(buf, w.size()));
+}
+
+void print_lookup(dns::answer_cache& c, const char* name, double now) {
+    dns::reply p;
+    bool hit = c.lookup(name, TYPE_A, now, p);
+    printf("%s @%g: ", name, now);
+    if (!hit)
+        printf("miss\n");
+    else
+        printf("hit err %d addrs %d ttl %u\n", p->err, (int) p->addrs.size(),
+               p->ttl);
+}
+
+void print_stats(const dns::answer_cache& c) {
+    const dns::answer_cache::stats_type& s = c.stats();
+    printf("size %d hits %d misses %d negative %d evictions %d\n",
+           (int) c.size(), (int) s.hits, (int) s.misses,
+           (int) s.negative_hits, (int) s.evictions);
+}
+
+void test_ttls() {
+    dns::reply p = make_response("www.example.com", 0, 300, 0, 0);
+    printf("positive err %d ttl %u\n", p->err, p->ttl);
+    p = make_response("nx.example.com", DNS_ERR_NOTEXIST, 0, 3600, 120);
+    printf("nxdomain err %d ttl %u\n", p->err, p->ttl);
+    p = make_response("nx.example.com", DNS_ERR_NOTEXIST, 0, 30, 120);
+    printf("nxdomain err %d ttl %u\n", p->err, p->ttl);
+    p = make_response("nx.example.com", DNS_ERR_NOTEXIST, 0, 0, 0);
+    printf("nxdomain without soa err %d ttl %u\n", p->err, p->ttl);
+    p = make_response("empty.example.com", 0, 0, 3600, 45);
+    printf("nodata err %d addrs %d ttl %u\n", p->err,
+           (int) p->addrs.size(), p->ttl);
+}
+
+void test_cache() {
+    dns::answer_cache c(3, 10, 1000, 5);
+    c.insert("www.example.com", TYPE_A,
+             make_response("www.example.com", 0, 300, 0, 0), 0);
+    c.insert("short.example.com", TYPE_A,
+             make_response("short.example.com", 0, 1, 0, 0), 0);
+    c.insert("long.example.com", TYPE_A,
+             make_response("long.example.com", 0, 100000, 0, 0), 0);
+    // a hit's TTL is the time left
+    print_lookup(c, "www.example.com", 100);
+    print_lookup(c, "www.example.com", 299);
+    print_lookup(c, "WWW.Example.COM", 299);
+    print_lookup(c, "www.example.com", 300);
+    // the 1-second TTL was raised to 10, the long one lowered to 1000
+    print_lookup(c, "short.example.com", 9);
+    print_lookup(c, "short.example.com", 10);
+    print_lookup(c, "long.example.com", 999);
+    print_lookup(c, "long.example.com", 1000);
+    print_stats(c);
+
+    // a different type is a different key
+    dns::reply p;
+    c.insert("www.example.com", TYPE_A,
+             make_response("www.example.com", 0, 300, 0, 0), 0);
+    printf("ptr lookup %d\n", c.lookup("www.example.com", TYPE_PTR, 0, p));
+
+    // negative answers
+    c.flush();
+    c.insert("nx.example.com", TYPE_A,
+             make_response("nx.example.com", DNS_ERR_NOTEXIST, 0, 3600, 120), 0);
+    c.insert("nosoa.example.com", TYPE_A,
+             make_response("nosoa.example.com", DNS_ERR_NOTEXIST, 0, 0, 0), 0);
+    c.insert("fail.example.com", TYPE_A,
+             make_response("fail.example.com", DNS_ERR_SERVERFAILED, 0, 0, 0), 0);
+    c.insert("null.example.com", TYPE_A, dns::reply(), 0);
+    print_lookup(c, "nx.example.com", 119);
+    print_lookup(c, "nx.example.com", 120);
+    print_lookup(c, "nosoa.example.com", 9);
+    print_lookup(c, "nosoa.example.com", 10);
+    print_lookup(c, "fail.example.com", 0);
+    print_lookup(c, "null.example.com", 0);
+    print_stats(c);
+}
+
+void test_lru() {
+    dns::answer_cache c(2);
+    c.insert("a", TYPE_A, make_response("a", 0, 60, 0, 0), 0);
+    c.insert("b", TYPE_A, make_response("b", 0, 60, 0, 0), 0);
+    print_lookup(c, "a", 1);
+    c.insert("c", TYPE_A, make_response("c", 0, 60, 0, 0), 2);
+    print_lookup(c, "b", 3);
+    print_lookup(c, "a", 3);
+    print_lookup(c, "c", 3);
+    c.set_capacity(1);
+    print_lookup(c, "a", 4);
+    print_lookup(c, "c", 4);
+    c.erase("c", TYPE_A);
+    print_lookup(c, "c", 4);
+    print_stats(c);
+
+    // a zero TTL is not cached unless the minimum raises it
+    dns::answer_cache z(2, 0, 60, 0);
+    z.insert("nx", TYPE_A, make_response("nx", DNS_ERR_NOTEXIST, 0, 0, 0), 0);
+    printf("zero ttl size %d\n", (int) z.size());
+    z.set_ttl_limits(5, 60);
+    z.insert("nx", TYPE_A, make_response("nx", DNS_ERR_NOTEXIST, 0, 0, 0), 0);
+    printf("raised ttl size %d\n", (int) z.size());
+    // ...but a positive answer with a TTL of 0 never is
+    dns::reply p = make_response("zero", 0, 300, 0, 0);
+    p->ttl = 0;
+    z.insert("zero", TYPE_A, p, 0);
+    printf("positive zero ttl cached %d\n", z.lookup("zero", TYPE_A, 0, p));
+}
+
+int main(int, char**) {
+    tamer::initialize();
+    test_ttls();
+    test_cache();
+    test_lru();
+    tamer::cleanup();
+}